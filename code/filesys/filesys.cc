@@ -30,7 +30,8 @@
 //
 // 	Our implementation at this point has the following restrictions:
 //
-//	   there is no synchronization for concurrent accesses
+//	   the directory and bitmap are protected by a reader-writer
+//	     lock, but the contents of files are not synchronized
 //	   files have a fixed size, set when the file is created
 //	   files cannot be bigger than about 3KB in size
 //	   there is no hierarchical directory structure, and only a limited
@@ -50,6 +51,7 @@
 #include "pbitmap.h"
 #include "directory.h"
 #include "filehdr.h"
+#include "synch.h"
 #include "filesys.h"
 
 // Sectors containing the file headers for the bitmap of free sectors,
@@ -81,6 +83,7 @@
 FileSystem::FileSystem(bool format)
 { 
     DEBUG(dbgFile, "Initializing the file system.");
+    lock = new RWLock("file system");
     if (format) {
         PersistentBitmap *freeMap = new PersistentBitmap(NumSectors);
         Directory *directory = new Directory(NumDirEntries);
@@ -93,6 +96,8 @@ FileSystem::FileSystem(bool format)
     // (make sure no one else grabs these!)
 	freeMap->Mark(FreeMapSector);	    
 	freeMap->Mark(DirectorySector);
+	for (int i = FirstSwapSector; i < NumSectors; i++)
+	    freeMap->Mark(i);		    // the swap area
 
     // Second, allocate space for the data blocks containing the contents
     // of the directory and bitmap files.  There better be enough space!
@@ -164,8 +169,8 @@ FileSystem::FileSystem(bool format)
 //	 	no free entry for file in directory
 //	 	no free space for data blocks for the file 
 //
-// 	Note that this implementation assumes there is no concurrent access
-//	to the file system!
+// 	The directory and bitmap are held for writing throughout, so
+//	that nobody sees (or makes) a half-done change.
 //
 //	"name" -- name of file to be created
 //	"initialSize" -- size of file to be created
@@ -182,6 +187,7 @@ FileSystem::Create(char *name, int initialSize)
 
     DEBUG(dbgFile, "Creating file " << name << " size " << initialSize);
 
+    lock->AcquireWrite();
     directory = new Directory(NumDirEntries);
     directory->FetchFrom(directoryFile);
 
@@ -210,6 +216,7 @@ FileSystem::Create(char *name, int initialSize)
         delete freeMap;
     }
     delete directory;
+    lock->ReleaseWrite();
     return success;
 }
 
@@ -219,6 +226,7 @@ FileSystem::Create(char *name, int initialSize)
 //	To open a file:
 //	  Find the location of the file's header, using the directory 
 //	  Bring the header into memory
+//	Any number of threads may look up files at the same time.
 //
 //	"name" -- the text name of the file to be opened
 //----------------------------------------------------------------------
@@ -231,10 +239,12 @@ FileSystem::Open(char *name)
     int sector;
 
     DEBUG(dbgFile, "Opening file" << name);
+    lock->AcquireRead();
     directory->FetchFrom(directoryFile);
     sector = directory->Find(name); 
     if (sector >= 0) 		
 	openFile = new OpenFile(sector);	// name was found in directory 
+    lock->ReleaseRead();
     delete directory;
     return openFile;				// return NULL if not found
 }
@@ -261,10 +271,12 @@ FileSystem::Remove(char *name)
     FileHeader *fileHdr;
     int sector;
     
+    lock->AcquireWrite();
     directory = new Directory(NumDirEntries);
     directory->FetchFrom(directoryFile);
     sector = directory->Find(name);
     if (sector == -1) {
+       lock->ReleaseWrite();
        delete directory;
        return FALSE;			 // file not found 
     }
@@ -279,6 +291,7 @@ FileSystem::Remove(char *name)
 
     freeMap->WriteBack(freeMapFile);		// flush to disk
     directory->WriteBack(directoryFile);        // flush to disk
+    lock->ReleaseWrite();
     delete fileHdr;
     delete directory;
     delete freeMap;
@@ -295,8 +308,10 @@ FileSystem::List()
 {
     Directory *directory = new Directory(NumDirEntries);
 
+    lock->AcquireRead();
     directory->FetchFrom(directoryFile);
     directory->List();
+    lock->ReleaseRead();
     delete directory;
 }
 
@@ -318,6 +333,7 @@ FileSystem::Print()
     PersistentBitmap *freeMap = new PersistentBitmap(freeMapFile,NumSectors);
     Directory *directory = new Directory(NumDirEntries);
 
+    lock->AcquireRead();
     printf("Bit map file header:\n");
     bitHdr->FetchFrom(FreeMapSector);
     bitHdr->Print();
@@ -330,6 +346,7 @@ FileSystem::Print()
 
     directory->FetchFrom(directoryFile);
     directory->Print();
+    lock->ReleaseRead();
 
     delete bitHdr;
     delete dirHdr;
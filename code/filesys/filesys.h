@@ -76,6 +76,8 @@ class FileSystem {
 };
 
 #else // FILESYS
+class RWLock;
+
 class FileSystem {
   public:
     FileSystem(bool format);		// Initialize the file system.
@@ -101,6 +103,8 @@ class FileSystem {
 					// represented as a file
    OpenFile* directoryFile;		// "Root" directory -- list of
 					// file names, represented as a file
+   RWLock *lock;			// guards the directory and bitmap;
+   					// lookups share it
 };
 
 #endif // FILESYS
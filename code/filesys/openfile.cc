@@ -105,6 +105,9 @@ OpenFile::Write(char *into, int numBytes)
 //	   in the data that will be modified, and write back all the full
 //	   or partial sectors that are part of the request.
 //
+//	The sector buffer comes from a pool of buffers of PooledSectors
+//	sectors (see pool.h); only bigger requests go to the host.
+//
 //	"into" -- the buffer to contain the data to be read from disk 
 //	"from" -- the buffer containing the data to be written to disk 
 //	"numBytes" -- the number of bytes to transfer
@@ -112,6 +115,9 @@ OpenFile::Write(char *into, int numBytes)
 //			read/written
 //----------------------------------------------------------------------
 
+const int PooledSectors = 4;	// most reads and writes need no more
+static ObjectPool bufferPool("sector buffer", PooledSectors * SectorSize);
+
 int
 OpenFile::ReadAt(char *into, int numBytes, int position)
 {
@@ -130,14 +136,14 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
     numSectors = 1 + lastSector - firstSector;
 
     // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
+    buf = (char *) bufferPool.Alloc(numSectors * SectorSize);
     for (i = firstSector; i <= lastSector; i++)	
         kernel->synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize), 
 					&buf[(i - firstSector) * SectorSize]);
 
     // copy the part we want
     bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete [] buf;
+    bufferPool.Free(buf, numSectors * SectorSize);
     return numBytes;
 }
 
@@ -159,7 +165,7 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
 
-    buf = new char[numSectors * SectorSize];
+    buf = (char *) bufferPool.Alloc(numSectors * SectorSize);
 
     firstAligned = (position == (firstSector * SectorSize));
     lastAligned = ((position + numBytes) == ((lastSector + 1) * SectorSize));
@@ -178,7 +184,7 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
     for (i = firstSector; i <= lastSector; i++)	
         kernel->synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize), 
 					&buf[(i - firstSector) * SectorSize]);
-    delete [] buf;
+    bufferPool.Free(buf, numSectors * SectorSize);
     return numBytes;
 }
 
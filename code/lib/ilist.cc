@@ -0,0 +1,206 @@
+// ilist.cc
+//     	Routines to manage a doubly linked list of items that carry
+//	their own links.
+//
+//	Nothing is allocated or freed here; the items belong to the
+//	caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::IntrusiveList
+//	Initialize an empty list.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+IntrusiveList<T, link>::IntrusiveList()
+{
+    first = last = NULL;
+    numInList = 0;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::~IntrusiveList
+//	Take the items that are still on the list off it, so that they
+//	can go on another list.  The items themselves are not touched
+//	otherwise.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+IntrusiveList<T, link>::~IntrusiveList()
+{
+    while (!IsEmpty())
+	(void) RemoveFront();
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::InsertAfter
+//	Link "item" in after "where", or at the front of the list if
+//	"where" is NULL.  The item must not be on any list through
+//	this link.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+IntrusiveList<T, link>::InsertAfter(T *where, T *item)
+{
+    ListLink<T> *l = &(item->*link);
+
+    ASSERT(l->list == NULL);
+    l->list = this;
+    l->prev = where;
+    if (where == NULL) {		// at the front
+	l->next = first;
+	first = item;
+    } else {
+	l->next = (where->*link).next;
+	(where->*link).next = item;
+    }
+    if (l->next == NULL)		// at the end
+	last = item;
+    else
+	(l->next->*link).prev = item;
+    numInList++;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::Append, Prepend
+//      Put an "item" at the end, or at the front, of the list.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+IntrusiveList<T, link>::Append(T *item)
+{
+    InsertAfter(last, item);
+}
+
+template <class T, ListLink<T> T::*link>
+void
+IntrusiveList<T, link>::Prepend(T *item)
+{
+    InsertAfter(NULL, item);
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::Remove
+//      Take "item" off the list, wherever it is.  It must be on it.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+IntrusiveList<T, link>::Remove(T *item)
+{
+    ListLink<T> *l = &(item->*link);
+
+    ASSERT(IsInList(item));
+    if (l->prev == NULL)
+	first = l->next;
+    else
+	(l->prev->*link).next = l->next;
+    if (l->next == NULL)
+	last = l->prev;
+    else
+	(l->next->*link).prev = l->prev;
+    l->prev = l->next = NULL;
+    l->list = NULL;
+    numInList--;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::RemoveFront
+//      Take the first item off the list, and return it.  The list
+//	must not be empty.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+T *
+IntrusiveList<T, link>::RemoveFront()
+{
+    T *item = first;
+
+    ASSERT(!IsEmpty());
+    Remove(item);
+    return item;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::Apply
+//      Apply function to every item on the list, front to back.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+IntrusiveList<T, link>::Apply(void (*func)(T *)) const
+{
+    for (T *item = first; item != NULL; item = (item->*link).next)
+	(*func)(item);
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::SanityCheck
+//      Test whether this is still a legal list: the links go both
+//	ways, end at first and last, and count numInList items.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+IntrusiveList<T, link>::SanityCheck() const
+{
+    T *item, *prev = NULL;
+    int numFound = 0;
+
+    for (item = first; item != NULL; prev = item, item = (item->*link).next) {
+	numFound++;
+	ASSERT(numFound <= numInList);		// prevent infinite loop
+	ASSERT((item->*link).prev == prev && IsInList(item));
+    }
+    ASSERT(numFound == numInList && last == prev);
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T, link>::SelfTest
+//      Test whether this module is working.  "p" is an array of
+//	"numEntries" items (at least 3), none of them on a list.
+//----------------------------------------------------------------------
+
+template <class T, ListLink<T> T::*link>
+void
+IntrusiveList<T, link>::SelfTest(T *p, int numEntries)
+{
+    IntrusiveListIterator<T, link> iterator(this);
+    int i;
+
+    SanityCheck();
+    ASSERT(IsEmpty() && first == NULL);
+    ASSERT(iterator.IsDone());		// nothing on list
+
+    for (i = 0; i < numEntries; i++) {
+	Append(&p[i]);
+	ASSERT(IsInList(&p[i]) && !IsEmpty());
+    }
+    SanityCheck();
+
+    // take out the middle, then the back, then the rest from the front
+    Remove(&p[numEntries / 2]);
+    ASSERT(!IsInList(&p[numEntries / 2]));
+    SanityCheck();
+    Remove(&p[numEntries - 1]);
+    SanityCheck();
+    Prepend(&p[numEntries - 1]);
+    ASSERT(Front() == &p[numEntries - 1]);
+    (void) RemoveFront();
+    for (i = 0; i < numEntries - 1; i++) {
+	if (i != numEntries / 2) {
+	    ASSERT(RemoveFront() == &p[i]);
+	}
+    }
+    ASSERT(IsEmpty());
+    SanityCheck();
+}
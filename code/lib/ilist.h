@@ -0,0 +1,115 @@
+// ilist.h
+//	Data structures to manage "intrusive" lists -- lists whose
+//	links are kept inside the items themselves.
+//
+//	A List allocates a ListElement for every item put on it, and
+//	has to search the list to find an item to remove.  For objects
+//	that the kernel moves on and off queues all the time (threads
+//	going from a ready queue to a semaphore and back, pending
+//	interrupts), the class instead has a ListLink member, and the
+//	list threads its items through that member.  Putting an item
+//	on the list allocates nothing, and since the list is doubly
+//	linked, and each link knows which list it is on, removing any
+//	item and checking whether it is on the list take O(1).
+//
+//	The price is that an object can be on only as many lists at a
+//	time as it has links.
+//
+//	The list is a template on the class of the items and on the
+//	member holding the link; for instance
+//		IntrusiveList<Thread, &Thread::queueLink>
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ILIST_H
+#define ILIST_H
+
+#include "copyright.h"
+#include "debug.h"
+
+// The following class defines the link an item keeps for one list.
+
+template <class T>
+class ListLink {
+  public:
+    ListLink() { prev = next = NULL; list = NULL; }
+
+    T *prev;			// previous item on the list, NULL if first
+    T *next;			// next item on the list, NULL if last
+    const void *list;		// the list the item is on, NULL if none
+};
+
+template <class T, ListLink<T> T::*link> class IntrusiveListIterator;
+
+// The following class defines an intrusive list: a doubly linked list
+// of items of class T, linked through their member "link".  Items are
+// compared by address.
+
+template <class T, ListLink<T> T::*link>
+class IntrusiveList {
+  public:
+    IntrusiveList();		// initialize the list
+    virtual ~IntrusiveList();	// take every item off the list
+
+    void Prepend(T *item);	// Put item at the beginning of the list
+    void Append(T *item);	// Put item at the end of the list
+
+    T *Front() { return first; }
+    				// Return first item on list
+				// without removing it
+    T *RemoveFront();		// Take item off the front of the list
+    void Remove(T *item);	// Remove specific item from list
+
+    bool IsInList(T *item) const { return (item->*link).list == this; }
+    				// is the item in the list?
+
+    unsigned int NumInList() { return numInList; }
+    				// how many items in the list?
+    bool IsEmpty() { return (numInList == 0); }
+    				// is the list empty?
+
+    void Apply(void (*func)(T *)) const;
+    				// apply function to all items in list
+
+    virtual void SanityCheck() const;
+				// has this list been corrupted?
+    void SelfTest(T *p, int numEntries);
+				// verify module is working
+
+  protected:
+    T *first;			// Head of the list, NULL if list is empty
+    T *last;			// Last item of list
+    int numInList;		// number of items in list
+
+    void InsertAfter(T *where, T *item);
+    				// Put "item" after "where", or at the
+				// front if "where" is NULL
+
+    friend class IntrusiveListIterator<T, link>;
+};
+
+// The following class can be used to step through an intrusive list,
+// the same way as a ListIterator.  The current item must not be
+// removed from the list before Next() is called.
+
+template <class T, ListLink<T> T::*link>
+class IntrusiveListIterator {
+  public:
+    IntrusiveListIterator(IntrusiveList<T, link> *list)
+    				{ current = list->first; }
+
+    bool IsDone() { return current == NULL; }
+    T *Item() { ASSERT(!IsDone()); return current; }
+    void Next() { current = (current->*link).next; }
+
+  private:
+    T *current;			// where we are in the list
+};
+
+#include "ilist.cc"		// templates, see list.h
+
+#endif // ILIST_H
@@ -1,6 +1,7 @@
 // libtest.cc 
 //	Driver code to call self-test routines for standard library
-//	classes -- bitmaps, lists, sorted lists, and hash tables.
+//	classes -- bitmaps, lists, sorted lists, intrusive lists, and
+//	hash tables.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -10,6 +11,7 @@
 #include "libtest.h"
 #include "bitmap.h"
 #include "list.h"
+#include "ilist.h"
 #include "hash.h"
 #include "sysdep.h"
 
@@ -53,6 +55,14 @@ HashKey(char *str) {
 // Array of values to be inserted into a List or SortedList. 
 static int listTestVector[] = { 9, 5, 7 };
 
+// Items to be put on an IntrusiveList; they carry their own link.
+class TestItem {
+  public:
+    int value;
+    ListLink<TestItem> link;
+};
+static TestItem ilistTestVector[4];
+
 // Array of values to be inserted into the HashTable
 // There are enough here to force a ReHash().
 static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
@@ -60,8 +70,8 @@ static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
 
 //----------------------------------------------------------------------
 // LibSelfTest
-//	Run self tests on bitmaps, lists, sorted lists, and 
-//	hash tables.
+//	Run self tests on bitmaps, lists, sorted lists, intrusive
+//	lists, and hash tables.
 //----------------------------------------------------------------------
 
 void
@@ -69,6 +79,8 @@ LibSelfTest () {
     Bitmap *map = new Bitmap(200);
     List<int> *list = new List<int>;
     SortedList<int> *sortList = new SortedList<int>(IntCompare);
+    IntrusiveList<TestItem, &TestItem::link> *ilist =
+	new IntrusiveList<TestItem, &TestItem::link>;
     HashTable<int, char *> *hashTable = 
 	new HashTable<int, char *>(HashKey, HashInt);
 	
@@ -76,10 +88,13 @@ LibSelfTest () {
     map->SelfTest();
     list->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
     sortList->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
+    ilist->SelfTest(ilistTestVector,
+			sizeof(ilistTestVector)/sizeof(TestItem));
     hashTable->SelfTest(hashTestVector, sizeof(hashTestVector)/sizeof(char *));
 
     delete map;
     delete list;
     delete sortList;
+    delete ilist;
     delete hashTable;
 }
@@ -32,6 +32,22 @@ ListElement<T>::ListElement(T itm)
      next = NULL;	// always initialize to something!
 }
 
+//----------------------------------------------------------------------
+// ListElement<T>::Pool
+// 	Return the pool of list elements for items of type T.  It is
+//	created the first time it is needed, so that lists can be used
+//	by the constructors of other static objects.
+//----------------------------------------------------------------------
+
+template <class T>
+ObjectPool *
+ListElement<T>::Pool()
+{
+    static ObjectPool pool("list element", sizeof(ListElement<T>));
+
+    return &pool;
+}
+
 
 //----------------------------------------------------------------------
 // List<T>::List
@@ -15,12 +15,16 @@
 
 #include "copyright.h"
 #include "debug.h"
+#include "pool.h"
 
 // The following class defines a "list element" -- which is
 // used to keep track of one item on a list.  It is equivalent to a
 // LISP cell, with a "car" ("next") pointing to the next element on the list,
 // and a "cdr" ("item") pointing to the item on the list.
 //
+// One is allocated for every item put on a list, so they come from a
+// pool (see pool.h), one for each type of item.
+//
 // This class is private to this module (and classes that inherit
 // from this module). Made public for notational convenience.
 
@@ -30,6 +34,13 @@ class ListElement {
     ListElement(T itm); 	// initialize a list element
     ListElement *next;	     	// next element on list, NULL if this is last
     T item; 	   	     	// item on the list
+
+    void *operator new(size_t size) { return Pool()->Alloc(size); }
+    void operator delete(void *element, size_t size)
+				{ Pool()->Free(element, size); }
+
+  private:
+    static ObjectPool *Pool();	// where list elements of this type live
 };
 
 // The following class defines a "list" -- a singly linked list of
@@ -0,0 +1,130 @@
+// pool.cc
+//	Routines to allocate small objects of one size from slabs.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "pool.h"
+
+ObjectPool *ObjectPool::pools = NULL;
+
+//----------------------------------------------------------------------
+// ObjectPool::ObjectPool
+// 	Initialize an empty pool, and add it to the list of all pools.
+//	No memory is taken from the host until the first allocation.
+//
+//	"debugName" is the class of the objects, for printing.
+//	"objectSize" is how big each of them is.
+//----------------------------------------------------------------------
+
+ObjectPool::ObjectPool(char *debugName, size_t objectSize)
+{
+    name = debugName;
+    size = (objectSize < sizeof(PoolObject)) ? sizeof(PoolObject)
+    					     : objectSize;
+    size = divRoundUp(size, sizeof(double)) * sizeof(double);	// align
+    freeList = NULL;
+    slabs = allocated = inUse = peak = tooBig = 0;
+    nextPool = pools;
+    pools = this;
+}
+
+//----------------------------------------------------------------------
+// ObjectPool::Grow
+// 	Take a slab of PoolSlabObjects objects from the host, and put
+//	them all on the free list.
+//----------------------------------------------------------------------
+
+void
+ObjectPool::Grow()
+{
+    char *slab = (char *) ::operator new(size * PoolSlabObjects);
+    PoolObject *object;
+
+    for (int i = PoolSlabObjects - 1; i >= 0; i--) {
+	object = (PoolObject *) (slab + i * size);
+	object->next = freeList;
+	freeList = object;
+    }
+    slabs++;
+}
+
+//----------------------------------------------------------------------
+// ObjectPool::Alloc
+// 	Return room for an object of "size" bytes: the first object on
+//	the free list, after adding a slab if it is empty.
+//----------------------------------------------------------------------
+
+void *
+ObjectPool::Alloc(size_t objectSize)
+{
+    PoolObject *object;
+
+    if (objectSize > size) {
+	tooBig++;
+	return ::operator new(objectSize);
+    }
+    if (freeList == NULL)
+	Grow();
+    object = freeList;
+    freeList = object->next;
+    allocated++;
+    inUse++;
+    if (inUse > peak)
+	peak = inUse;
+    return (void *) object;
+}
+
+//----------------------------------------------------------------------
+// ObjectPool::Free
+// 	Put "object" back on the free list -- at the front, so that
+//	the next allocation gets memory that is still in the host's
+//	cache.  "size" must be what it was allocated with.
+//----------------------------------------------------------------------
+
+void
+ObjectPool::Free(void *object, size_t objectSize)
+{
+    PoolObject *freed = (PoolObject *) object;
+
+    if (object == NULL)
+	return;
+    if (objectSize > size) {
+	::operator delete(object);
+	return;
+    }
+    ASSERT(inUse > 0);
+    freed->next = freeList;
+    freeList = freed;
+    inUse--;
+}
+
+//----------------------------------------------------------------------
+// ObjectPool::Print, PrintAll
+// 	Print how the pool was used: objects handed out, how many are
+//	in use now and were at most, and slabs taken from the host.
+//----------------------------------------------------------------------
+
+void
+ObjectPool::Print()
+{
+    cout << "  " << name << " (" << size << " bytes): " << allocated
+	<< " allocated, " << inUse << " in use, peak " << peak << ", "
+	<< slabs << " slabs";
+    if (tooBig > 0)
+	cout << ", " << tooBig << " too big";
+    cout << "\n";
+}
+
+void
+ObjectPool::PrintAll()
+{
+    cout << "Object pools:\n";
+    for (ObjectPool *pool = pools; pool != NULL; pool = pool->nextPool) {
+	if (pool->allocated > 0 || pool->tooBig > 0)
+	    pool->Print();
+    }
+}
@@ -0,0 +1,76 @@
+// pool.h
+//	Data structures for allocating small kernel objects of one
+//	class quickly.
+//
+//	The kernel creates and destroys some objects all the time: a
+//	ListElement for every item put on a list, a PendingInterrupt
+//	for every interrupt scheduled, a buffer for every file read or
+//	write.  Going to the host allocator each time shows up in any
+//	profile of the simulation.  Instead, such a class gets its own
+//	pool (through its operator new and operator delete), which
+//	takes memory from the host a slab of PoolSlabObjects objects at
+//	a time, and keeps freed objects on a free list, threaded through
+//	the objects themselves, for the next allocation.  Slabs are
+//	never given back; the pool only grows to the most objects that
+//	were ever in use at once.
+//
+//	Each pool counts how it is used; ObjectPool::PrintAll prints the
+//	counts of all of them.
+//
+//	Requests larger than the objects of the pool (a derived class,
+//	say) are passed on to the host allocator.
+//
+//	NOTE: Mutual exclusion must be provided by the caller; in the
+//	kernel, allocation is never interrupted by another thread.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "copyright.h"
+#include <stddef.h>
+
+// How many objects the pool takes from the host at a time
+const int PoolSlabObjects = 64;
+
+// The following class defines a free object, on the free list.
+
+class PoolObject {
+  public:
+    PoolObject *next;
+};
+
+// The following class defines a pool of objects of one size.
+
+class ObjectPool {
+  public:
+    ObjectPool(char *debugName, size_t objectSize);
+				// Initialize an empty pool of objects of
+				// "objectSize" bytes
+
+    void *Alloc(size_t size);	// Return room for "size" bytes
+    void Free(void *object, size_t size);
+				// Give back what Alloc(size) returned
+
+    void Print();		// How the pool was used
+    static void PrintAll();	// ... for every pool that was used
+
+  private:
+    char *name;			// debugging assist
+    size_t size;		// of each object, at least a pointer
+    PoolObject *freeList;	// objects not in use
+    int slabs;			// taken from the host
+    int allocated;		// objects handed out
+    int inUse, peak;		// objects in use, now and at most
+    int tooBig;			// requests passed on to the host
+
+    ObjectPool *nextPool;	// all the pools, for PrintAll
+    static ObjectPool *pools;
+
+    void Grow();		// Add a slab to the free list
+};
+
+#endif // POOL_H
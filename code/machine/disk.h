@@ -53,6 +53,12 @@ const int NumTracks = 32;		// number of tracks per disk
 const int NumSectors = (SectorsPerTrack * NumTracks);
 					// total # of sectors per disk
 
+// The last NumSwapSectors sectors of the disk are the swap area for
+// paging (see userprog/frametable.h); the file system never hands
+// them out, so swapping can't overwrite files.
+const int NumSwapSectors = NumSectors / 2;
+const int FirstSwapSector = NumSectors - NumSwapSectors;
+
 class Disk : public CallBackObj {
   public:
     Disk(CallBackObj *toCall);          // Create a simulated disk.  
@@ -50,16 +50,23 @@ PendingInterrupt::PendingInterrupt(CallBackObj *callOnInt,
 }
 
 //----------------------------------------------------------------------
-// PendingCompare
-//	Compare to interrupts based on which should occur first.
+// PendingInterrupt::operator new, PendingInterrupt::operator delete
+// 	Take the room for a pending interrupt from a pool, and give it
+//	back there (see pool.h).
 //----------------------------------------------------------------------
 
-static int
-PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
+static ObjectPool pendingPool("pending interrupt", sizeof(PendingInterrupt));
+
+void *
+PendingInterrupt::operator new(size_t size)
 {
-    if (x->when < y->when) { return -1; }
-    else if (x->when > y->when) { return 1; }
-    else { return 0; }
+    return pendingPool.Alloc(size);
+}
+
+void
+PendingInterrupt::operator delete(void *pending, size_t size)
+{
+    pendingPool.Free(pending, size);
 }
 
 //----------------------------------------------------------------------
@@ -72,7 +79,7 @@ PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new SortedList<PendingInterrupt *>(PendingCompare);
+    pending = new InterruptHeap();
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -167,8 +174,8 @@ Interrupt::OneTick()
     CheckIfDue(FALSE);		// check for pending interrupts
     ChangeLevel(IntOff, IntOn);	// re-enable interrupts
 
-	/* MP3 if currentThread is RR and time to switch */
-    if (yieldOnReturn && kernel->currentThread->getPriority() <= 49)
+	/* MP3 if currentThread may be time sliced and time to switch */
+    if (yieldOnReturn && kernel->scheduler->Preemptible())
 	{	// if the timer device handler asked
     				// for a context switch, ok to do it now
 		yieldOnReturn = FALSE;
@@ -178,28 +185,7 @@ Interrupt::OneTick()
     }
 
 	/* MP3 Check Aging */
-	ListIterator<Thread *> *iterL1 = new ListIterator<Thread *>(kernel->scheduler->L1Queue);
-	ListIterator<Thread *> *iterL2 = new ListIterator<Thread *>(kernel->scheduler->L2Queue);
-	ListIterator<Thread *> *iterL3 = new ListIterator<Thread *>(kernel->scheduler->readyList);
-
-	for (; !iterL1->IsDone(); iterL1->Next())
-	{
-		Thread* t = iterL1->Item();
-		kernel->scheduler->L1Queue->Remove(t);
-		bool ag = kernel->scheduler->CheckAging(t);
-		if(!ag) kernel->scheduler->L1Queue->Insert(t);
-  	}
-
-	for (; !iterL2->IsDone(); iterL2->Next())
-	{
-		Thread* t = iterL2->Item();
-		kernel->scheduler->L2Queue->Remove(t);
-		bool ag = kernel->scheduler->CheckAging(t);
-		if(!ag) kernel->scheduler->L2Queue->Insert(t);
-	}
-
-	for (; !iterL3->IsDone(); iterL3->Next())
-		kernel->scheduler->CheckAging(iterL3->Item());
+	kernel->scheduler->Tick();
 }
 
 //----------------------------------------------------------------------
@@ -249,6 +235,8 @@ Interrupt::Idle()
 
     DEBUG(dbgInt, "Machine idle.  No interrupts to do.");
     cout << "No threads ready or runnable, and no pending interrupts.\n";
+    if (kernel->synchProfiler != NULL)	// any thread still blocked
+	kernel->synchProfiler->CheckDeadlock();	// never wakes up
     cout << "Assuming the program completed.\n";
     Halt();
 }
@@ -263,6 +251,7 @@ Interrupt::Halt()
     cout << "Machine halting!\n\n";
     cout << "This is halt\n";
     kernel->stats->Print();
+    kernel->Report();
     delete kernel;	// Never returns.
 }
 
@@ -278,7 +267,7 @@ Interrupt::CreateFile(char *filename)
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: just put it on the heap of pending interrupts.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -35,6 +35,7 @@
 
 #include "copyright.h"
 #include "list.h"
+#include "interruptheap.h"
 #include "callback.h"
 
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
@@ -61,6 +62,10 @@ class PendingInterrupt {
 				// initialize an interrupt that will
 				// occur in the future
 
+    void *operator new(size_t size);	// from a pool; one is allocated
+    void operator delete(void *pending, size_t size);
+					// for every interrupt scheduled
+
     CallBackObj *callOnInterrupt;// The object (in the hardware device
 				// emulator) to call when the interrupt occurs
 
@@ -127,9 +132,8 @@ class Interrupt {
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    SortedList<PendingInterrupt *> *pending;
-    				// the list of interrupts scheduled
-				// to occur in the future
+    InterruptHeap *pending;	// the interrupts scheduled to occur
+				// in the future, earliest first
     //int writeFileNo;            //UNIX file emulating the display
     bool inHandler;		// TRUE if we are running an interrupt handler
     //bool putBusy;               // Is a PrintInt operation in progress
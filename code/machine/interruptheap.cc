@@ -0,0 +1,180 @@
+// interruptheap.cc
+//	Routines for the 4-ary heap of pending interrupts.
+//
+//	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "interruptheap.h"
+#include "interrupt.h"
+
+// Initial number of interrupts the heap has room for; it doubles as
+// needed.
+const int InitialInterruptHeapSize = 64;
+
+//----------------------------------------------------------------------
+// InterruptHeap::InterruptHeap
+// 	Initialize an empty heap.
+//----------------------------------------------------------------------
+
+InterruptHeap::InterruptHeap()
+{
+    size = InitialInterruptHeapSize;
+    entries = new HeapEntry[size];
+    numInHeap = 0;
+    nextOrder = 0;
+}
+
+//----------------------------------------------------------------------
+// InterruptHeap::~InterruptHeap
+// 	De-allocate the heap.  The interrupts on it are not touched.
+//----------------------------------------------------------------------
+
+InterruptHeap::~InterruptHeap()
+{
+    delete [] entries;
+}
+
+//----------------------------------------------------------------------
+// InterruptHeap::Insert
+// 	Put "pending" on the heap, growing it if it is full.  The new
+//	entry starts at the bottom, and its parents move down into the
+//	hole until one is due before it.
+//----------------------------------------------------------------------
+
+void
+InterruptHeap::Insert(PendingInterrupt *pending)
+{
+    HeapEntry entry;
+    int i, parent;
+
+    if (numInHeap == size) {
+	HeapEntry *newEntries = new HeapEntry[2 * size];
+
+	for (i = 0; i < numInHeap; i++)
+	    newEntries[i] = entries[i];
+	delete [] entries;
+	entries = newEntries;
+	size *= 2;
+    }
+    entry.when = pending->when;
+    entry.order = nextOrder++;
+    entry.pending = pending;
+
+    for (i = numInHeap++; i > 0; i = parent) {
+	parent = (i - 1) / HeapArity;
+	if (!Before(entry, entries[parent]))
+	    break;
+	entries[i] = entries[parent];
+    }
+    entries[i] = entry;
+}
+
+//----------------------------------------------------------------------
+// InterruptHeap::RemoveFront
+// 	Take the interrupt that is due first off the heap, and return
+//	it.  The last entry fills the hole at the root, moving down
+//	past the earliest of its children until it is due before all
+//	of them.  The heap must not be empty.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+InterruptHeap::RemoveFront()
+{
+    PendingInterrupt *pending;
+    HeapEntry last;
+    int i, child, first, end;
+
+    ASSERT(numInHeap > 0);
+    pending = entries[0].pending;
+    last = entries[--numInHeap];
+
+    for (i = 0; ; i = child) {
+	first = HeapArity * i + 1;
+	if (first >= numInHeap)
+	    break;
+	end = min(first + HeapArity, numInHeap);
+	child = first;
+	for (int c = first + 1; c < end; c++) {
+	    if (Before(entries[c], entries[child]))
+		child = c;
+	}
+	if (!Before(entries[child], last))
+	    break;
+	entries[i] = entries[child];
+    }
+    if (numInHeap > 0)
+	entries[i] = last;
+    return pending;
+}
+
+//----------------------------------------------------------------------
+// InterruptHeap::Apply
+// 	Apply "func" to every pending interrupt, in heap order (not
+//	sorted).
+//----------------------------------------------------------------------
+
+void
+InterruptHeap::Apply(void (*func)(PendingInterrupt *)) const
+{
+    for (int i = 0; i < numInHeap; i++)
+	(*func)(entries[i].pending);
+}
+
+//----------------------------------------------------------------------
+// InterruptHeap::SanityCheck
+// 	Check that no entry is due before its parent, and that each
+//	entry still has the time of its interrupt.
+//----------------------------------------------------------------------
+
+void
+InterruptHeap::SanityCheck() const
+{
+    for (int i = 0; i < numInHeap; i++) {
+	ASSERT(entries[i].when == entries[i].pending->when);
+	if (i > 0) {
+	    ASSERT(!Before(entries[i], entries[(i - 1) / HeapArity]));
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// InterruptHeap::SelfTest
+// 	Schedule "numEntries" interrupts, many of them at the same
+//	times, and check that they come out sorted on time and, within
+//	a time, in the order they were scheduled.  The heap must be
+//	empty.
+//----------------------------------------------------------------------
+
+void
+InterruptHeap::SelfTest(int numEntries)
+{
+    PendingInterrupt **scheduled = new PendingInterrupt *[numEntries];
+    PendingInterrupt *pending;
+    int i, index, lastIndex = -1, lastWhen = -1;
+
+    ASSERT(IsEmpty());
+    for (i = 0; i < numEntries; i++) {
+	scheduled[i] = new PendingInterrupt(NULL, (i * 7) % 5, TimerInt);
+	Insert(scheduled[i]);
+	SanityCheck();
+    }
+    for (i = 0; i < numEntries; i++) {
+	pending = RemoveFront();
+	SanityCheck();
+	for (index = 0; scheduled[index] != pending; index++)
+	    continue;
+	ASSERT(pending->when >= lastWhen);
+	if (pending->when == lastWhen) {
+	    ASSERT(index > lastIndex);
+	}
+	lastWhen = pending->when;
+	lastIndex = index;
+	delete pending;
+    }
+    ASSERT(IsEmpty());
+    delete [] scheduled;
+}
@@ -0,0 +1,75 @@
+// interruptheap.h
+//	Data structures for the queue of pending hardware interrupts.
+//
+//	Every device schedules its next interrupt all the time, so the
+//	queue is used on nearly every simulated tick, and with many
+//	devices busy (or a benchmark) it gets long.  A sorted list costs
+//	O(n) per insertion; this is a 4-ary min-heap on the time the
+//	interrupt is due, which costs O(log n) to insert and to remove
+//	the next interrupt.  A 4-ary heap is half as deep as a binary
+//	one, and the four children of a node sit next to each other in
+//	memory, so a sift down touches fewer cache lines.
+//
+//	The heap keeps the time of each interrupt next to the pointer,
+//	so that comparisons do not have to follow it.  Interrupts due at
+//	the same time come out in the order they were scheduled, like
+//	they did from the sorted list, so a run stays deterministic.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef INTERRUPTHEAP_H
+#define INTERRUPTHEAP_H
+
+#include "copyright.h"
+
+class PendingInterrupt;
+
+// Children per node of the heap
+const int HeapArity = 4;
+
+// The following class defines one entry of the heap.
+
+class HeapEntry {
+  public:
+    int when;			// when the interrupt is due
+    int order;			// when it was scheduled, to keep
+				// interrupts due at the same time FIFO
+    PendingInterrupt *pending;
+};
+
+// The following class defines the heap.
+
+class InterruptHeap {
+  public:
+    InterruptHeap();		// Initialize an empty heap
+    ~InterruptHeap();		// The interrupts on it are not touched
+
+    void Insert(PendingInterrupt *pending);
+				// Put an interrupt on the heap
+    PendingInterrupt *RemoveFront();
+				// Take the earliest one off
+    PendingInterrupt *Front() { return entries[0].pending; }
+    bool IsEmpty() { return numInHeap == 0; }
+    int NumInList() { return numInHeap; }
+    void Apply(void (*func)(PendingInterrupt *)) const;
+				// Apply "func" to every interrupt, in
+				// no particular order
+
+    void SanityCheck() const;	// Is the heap still a heap?
+    void SelfTest(int numEntries);
+				// Check the order interrupts come out in
+
+  private:
+    HeapEntry *entries;		// the heap, earliest at index 0
+    int numInHeap;
+    int size;			// room allocated in "entries"
+    int nextOrder;
+
+    bool Before(const HeapEntry &x, const HeapEntry &y) const {
+	return x.when < y.when || (x.when == y.when && x.order < y.order);
+    }
+};
+
+#endif // INTERRUPTHEAP_H
@@ -56,6 +56,7 @@ Machine::Machine(bool debug)
 {
     int i;
 
+    registers = initialRegisters;
     for (i = 0; i < NumTotalRegs; i++)
         registers[i] = 0;
     mainMemory = new char[MemorySize];
@@ -64,7 +65,7 @@ Machine::Machine(bool debug)
 #ifdef USE_TLB
     tlb = new TranslationEntry[TLBSize];
     for (i = 0; i < TLBSize; i++)
-	tlb[i].valid = FALSE;
+	tlb[i].valid = tlb[i].large = FALSE;
     pageTable = NULL;
 #else	// use linear page table
     tlb = NULL;
@@ -222,3 +223,27 @@ Machine::WriteRegister(int num, int value)
     registers[num] = value;
 }
 
+//----------------------------------------------------------------------
+// Machine::UseRegisters/DropRegisters
+//   	Switch the CPU registers to another block, or away from one
+//	that is going to be freed.  On real hardware the registers
+//	would have to be copied; here, the simulated CPU can just as
+//	well work on the thread's own copy.
+//----------------------------------------------------------------------
+
+void
+Machine::UseRegisters(int *block)
+{
+    registers = block;
+}
+
+void
+Machine::DropRegisters(int *block)
+{
+    if (registers == block) {
+	for (int i = 0; i < NumTotalRegs; i++)
+	    initialRegisters[i] = block[i];
+	registers = initialRegisters;
+    }
+}
+
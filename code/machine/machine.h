@@ -39,6 +39,8 @@ const int NumPhysPages = 128;
 
 const int MemorySize = (NumPhysPages * PageSize);
 const int TLBSize = 4;			// if there is a TLB, make it small
+const int LargePagePages = 16;		// pages mapped by one large
+					// translation entry; a power of 2
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -105,6 +107,15 @@ class Machine {
     void WriteRegister(int num, int value);
 				// store a value into a CPU register
 
+    void UseRegisters(int *block);
+				// From now on, the CPU registers are kept
+				// in "block" (NumTotalRegs words); the
+				// kernel switches blocks on a context
+				// switch instead of copying the registers
+    void DropRegisters(int *block);
+				// "block" is about to be freed; stop
+				// using it, if we are
+
 // Data structures accessible to the Nachos kernel -- main memory and the
 // page table/TLB.
 //
@@ -171,7 +182,11 @@ class Machine {
 
 // Internal data structures
 
-    int registers[NumTotalRegs]; // CPU registers, for executing user programs
+    int *registers;		// CPU registers, for executing user programs;
+				// the block of the thread running one
+    int initialRegisters[NumTotalRegs];
+				// the registers before any user program
+				// runs, or after its thread is gone
 
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
@@ -22,6 +22,10 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numPageReclaims = numPageOuts = 0;
+    numPrefetches = numPrefetchHits = numPrefetchWaste = 0;
+    numTlbMisses = numLargePages = 0;
+    numTimerInterrupts = 0;
 }
 
 //----------------------------------------------------------------------
@@ -43,3 +47,21 @@ Statistics::Print()
     cout << "Network I/O: packets received " << numPacketsRecvd;
 		cout << ", sent " << numPacketsSent << "\n";
 }
+
+//----------------------------------------------------------------------
+// Statistics::PrintPaging
+// 	Print what the pager and the TLB did, when asked for at
+//	system shutdown.
+//----------------------------------------------------------------------
+
+void
+Statistics::PrintPaging()
+{
+    cout << "Page-outs: reclaims " << numPageReclaims;
+		cout << ", written " << numPageOuts << "\n";
+    cout << "Prefetch: pages " << numPrefetches;
+		cout << ", hits " << numPrefetchHits;
+		cout << ", wasted " << numPrefetchWaste << "\n";
+    cout << "Translation: TLB misses " << numTlbMisses;
+		cout << ", large pages " << numLargePages << "\n";
+}
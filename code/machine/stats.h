@@ -33,12 +33,21 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numPageReclaims;	// faults served from the free pool
+    int numPageOuts;		// dirty pages written back by the pager
+    int numPrefetches;		// pages read ahead on page faults
+    int numPrefetchHits;	// ... that were referenced afterwards
+    int numPrefetchWaste;	// ... that were evicted unreferenced
+    int numTlbMisses;		// translations not found in the TLB
+    int numLargePages;		// large page mappings made
+    int numTimerInterrupts;	// timer interrupts taken
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
     Statistics(); 		// initialize everything to zero
 
     void Print();		// print collected statistics
+    void PrintPaging();		// ... and those of the pager
 };
 
 // Constants used to reflect the relative time an operation would
@@ -5,7 +5,7 @@
 //      This means it can be used for implementing time-slicing.
 //
 //      We emulate a hardware timer by scheduling an interrupt to occur
-//      every time stats->totalTicks has increased by TimerTicks.
+//      every time stats->totalTicks has increased by the time slice.
 //
 //      In order to introduce some randomness into time-slicing, if "doRandom"
 //      is set, then the interrupt is comes after a random number of ticks.
@@ -32,14 +32,18 @@
 //
 //      "doRandom" -- if true, arrange for the interrupts to occur
 //		at random, instead of fixed, intervals.
+//      "ticks" is the (average) time between interrupts.
 //      "toCall" is the interrupt handler to call when the timer expires.
 //----------------------------------------------------------------------
 
-Timer::Timer(bool doRandom, CallBackObj *toCall)
+Timer::Timer(bool doRandom, int ticks, CallBackObj *toCall)
 {
     randomize = doRandom;
+    period = ticks;
     callPeriodically = toCall;
     disable = FALSE;
+    suspended = FALSE;
+    armed = FALSE;
     SetInterrupt();
 }
 
@@ -52,6 +56,9 @@ Timer::Timer(bool doRandom, CallBackObj *toCall)
 void
 Timer::CallBack()
 {
+    armed = FALSE;
+    kernel->stats->numTimerInterrupts++;
+
     // invoke the Nachos interrupt handler for this device
     callPeriodically->CallBack();
 
@@ -62,20 +69,35 @@ Timer::CallBack()
 //----------------------------------------------------------------------
 // Timer::SetInterrupt
 //      Cause a timer interrupt to occur in the future, unless
-//	future interrupts have been disabled.  The delay is either
-//	fixed or random.
+//	future interrupts have been disabled or suspended.  The delay
+//	is either fixed or random.
 //----------------------------------------------------------------------
 
 void
 Timer::SetInterrupt()
 {
-    if (!disable) {
-       int delay = TimerTicks;
+    if (!disable && !suspended) {
+       int delay = period;
 
        if (randomize) {
-	     delay = 1 + (RandomNumber() % (TimerTicks * 2));
+	     delay = 1 + (RandomNumber() % (period * 2));
         }
        // schedule the next timer device interrupt
        kernel->interrupt->Schedule(this, delay, TimerInt);
+       armed = TRUE;
     }
 }
+
+//----------------------------------------------------------------------
+// Timer::Resume
+//      Undo Suspend: the next interrupt comes one period from now
+//	(unless the one before the suspend has not fired yet).
+//----------------------------------------------------------------------
+
+void
+Timer::Resume()
+{
+    suspended = FALSE;
+    if (!armed)
+	SetInterrupt();
+}
@@ -6,7 +6,8 @@
 //	having a thread go to sleep for a specific period of time.
 //
 //	We emulate a hardware timer by scheduling an interrupt to occur
-//	every time stats->totalTicks has increased by TimerTicks.
+//	every time stats->totalTicks has increased by "period" (by default,
+//	TimerTicks).
 //
 //	In order to introduce some randomness into time-slicing, if "doRandom"
 //	is set, then the interrupt comes after a random number of ticks.
@@ -27,20 +28,28 @@
 // The following class defines a hardware timer.
 class Timer : public CallBackObj {
   public:
-    Timer(bool doRandom, CallBackObj *toCall);
+    Timer(bool doRandom, int ticks, CallBackObj *toCall);
 				// Initialize the timer, and callback to "toCall"
-				// every time slice.
+				// every "ticks" ticks.
     virtual ~Timer() {}
 
     void Disable() { disable = TRUE; }
     				// Turn timer device off, so it doesn't
 				// generate any more interrupts.
+    void Suspend() { suspended = TRUE; }
+    				// Don't schedule another interrupt after
+				// the pending one, until Resume
+    void Resume();		// Start interrupting again, if suspended
+    bool IsSuspended() { return suspended; }
 
   private:
     bool randomize;		// set if we need to use a random timeout delay
-    CallBackObj *callPeriodically; // call this every TimerTicks time units
+    int period;			// (average) ticks between interrupts
+    CallBackObj *callPeriodically; // call this every "period" time units
     bool disable;		// turn off the timer device after next
     				// interrupt.
+    bool suspended;		// like disable, but can be resumed
+    bool armed;			// an interrupt is scheduled
 
     void CallBack();		// called internally when the hardware
 				// timer generates an interrupt
@@ -175,6 +175,10 @@ Machine::WriteMem(int addr, int size, int value)
 //	address in "physAddr".  If there was an error, returns the type
 //	of the exception.
 //
+//	A large entry (see translate.h) covers every page of its region:
+//	in the page table we check the entry at the start of the region
+//	first, and in the TLB it matches any page of the region.
+//
 //	"virtAddr" -- the virtual address to translate
 //	"physAddr" -- the place to store the physical address
 //	"size" -- the amount of memory being read or written
@@ -185,7 +189,7 @@ ExceptionType
 Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 {
     int i;
-    unsigned int vpn, offset;
+    unsigned int vpn, offset, largeVpn;
     TranslationEntry *entry;
     unsigned int pageFrame;
 
@@ -205,23 +209,30 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     vpn = (unsigned) virtAddr / PageSize;
     offset = (unsigned) virtAddr % PageSize;
     
+    largeVpn = vpn & ~(LargePagePages - 1);
     if (tlb == NULL) {		// => page table => vpn is index into table
 	if (vpn >= pageTableSize) {
 	    DEBUG(dbgAddr, "Illegal virtual page # " << virtAddr);
 	    return AddressErrorException;
-	} else if (!pageTable[vpn].valid) {
-	    DEBUG(dbgAddr, "Invalid virtual page # " << virtAddr);
-	    return PageFaultException;
 	}
-	entry = &pageTable[vpn];
+	entry = &pageTable[largeVpn];
+	if (!(entry->valid && entry->large)) {
+	    if (!pageTable[vpn].valid) {
+		DEBUG(dbgAddr, "Invalid virtual page # " << virtAddr);
+		return PageFaultException;
+	    }
+	    entry = &pageTable[vpn];
+	}
     } else {
         for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (tlb[i].virtualPage == ((int)vpn))) {
+    	    if (tlb[i].valid && (tlb[i].virtualPage ==
+			(int)(tlb[i].large ? largeVpn : vpn))) {
 		entry = &tlb[i];			// FOUND!
 		break;
 	    }
 	if (entry == NULL) {				// not found
     	    DEBUG(dbgAddr, "Invalid TLB entry for this virtual page!");
+	    kernel->stats->numTlbMisses++;
     	    return PageFaultException;		// really, this is a TLB fault,
 						// the page may be in memory,
 						// but not in the TLB
@@ -232,7 +243,7 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	DEBUG(dbgAddr, "Write to read-only page at " << virtAddr);
 	return ReadOnlyException;
     }
-    pageFrame = entry->physicalPage;
+    pageFrame = entry->physicalPage + (vpn - entry->virtualPage);
 
     // if the pageFrame is too big, there is something really wrong! 
     // An invalid translation was loaded into the page table or TLB. 
@@ -26,6 +26,12 @@
 // virtual page to one physical page.
 // In addition, there are some extra bits for access control (valid and 
 // read-only) and some bits for usage information (use and dirty).
+//
+// An entry marked "large" instead maps LargePagePages consecutive virtual
+// pages, starting at "virtualPage" (a multiple of LargePagePages), to as
+// many consecutive physical pages starting at "physicalPage".  In a page
+// table, a large entry sits at the index of the first page it maps;
+// its use and dirty bits stand for the whole region.
 
 class TranslationEntry {
   public:
@@ -40,6 +46,8 @@ class TranslationEntry {
 			// page is referenced or modified.
     bool dirty;         // This bit is set by the hardware every time the
 			// page is modified.
+    bool large;		// If this bit is set, the entry maps a whole
+			// naturally aligned region of LargePagePages.
 };
 
 #endif
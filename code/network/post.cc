@@ -43,13 +43,15 @@ Mail::Mail(PacketHeader pktH, MailHeader mailH, char *msgData)
 //      Initialize a single mail box within the post office, so that it
 //	can receive incoming messages.
 //
-//	Just initialize a list of messages, representing the mailbox.
+//	Just initialize a queue of messages, representing the mailbox.
 //----------------------------------------------------------------------
 
 
 MailBox::MailBox()
 {
-    messages = new SynchList<Mail *>();
+    messages = new SynchRing<Mail>(MailBoxSize);
+    overflow = new List<Mail *>;
+    lock = new Lock("mailbox");
 }
 
 //----------------------------------------------------------------------
@@ -63,6 +65,10 @@ MailBox::MailBox()
 MailBox::~MailBox()
 {
     delete messages;
+    while (!overflow->IsEmpty())
+	delete overflow->RemoveFront();
+    delete overflow;
+    delete lock;
 }
 
 //----------------------------------------------------------------------
@@ -84,10 +90,16 @@ PrintHeader(PacketHeader pktHdr, MailHeader mailHdr)
 //----------------------------------------------------------------------
 // MailBox::Put
 // 	Add a message to the mailbox.  If anyone is waiting for message
-//	arrival, wake them up!
+//	arrival, wake them up!  If the mailbox is full, the message goes
+//	on the overflow list, to be moved in as Get makes room; we are
+//	called by the postal worker, which must not wait for one slow
+//	receiver (it may wait for the lock, which Get holds only long
+//	enough to move one message).  Once anything is on the overflow
+//	list, later messages go there too, so they stay in order.
 //
 //	We need to reconstruct the Mail message (by concatenating the headers
-//	to the data), to simplify queueing the message on the SynchList.
+//	to the data), to simplify queueing the message.  It is copied
+//	straight into the mailbox; only overflow is allocated.
 //
 //	"pktHdr" -- source, destination machine ID's
 //	"mailHdr" -- source, destination mailbox ID's
@@ -97,11 +109,16 @@ PrintHeader(PacketHeader pktHdr, MailHeader mailHdr)
 void
 MailBox::Put(PacketHeader pktHdr, MailHeader mailHdr, char *data)
 {
-    Mail *mail = new Mail(pktHdr, mailHdr, data);
-
-    messages->Append(mail);		// put on the end of the list of
-					// arrived messages, and wake up
-					// any waiters
+    Mail mail(pktHdr, mailHdr, data);
+
+    lock->Acquire();
+    // put on the end of the queue of arrived messages, and wake up
+    // any waiters
+    if (!overflow->IsEmpty() || !messages->TryAppend(mail)) {
+	DEBUG(dbgNet, "Mailbox " << mailHdr.to << " full, message held");
+	overflow->Append(new Mail(mail));
+    }
+    lock->Release();
 }
 
 //----------------------------------------------------------------------
@@ -120,20 +137,29 @@ void
 MailBox::Get(PacketHeader *pktHdr, MailHeader *mailHdr, char *data)
 {
     DEBUG(dbgNet, "Waiting for mail in mailbox");
-    Mail *mail = messages->RemoveFront();	// remove message from list;
-						// will wait if list is empty
+    Mail mail = messages->RemoveFront();	// remove message from queue;
+						// will wait if it is empty
+    Mail *held;
+    bool moved;
+
+    lock->Acquire();
+    if (!overflow->IsEmpty()) {		// move one into the room we made
+	held = overflow->RemoveFront();
+	moved = messages->TryAppend(*held);
+	ASSERT(moved);
+	delete held;
+    }
+    lock->Release();
 
-    *pktHdr = mail->pktHdr;
-    *mailHdr = mail->mailHdr;
+    *pktHdr = mail.pktHdr;
+    *mailHdr = mail.mailHdr;
     if (debug->IsEnabled('n')) {
 	cout << "Got mail from mailbox: ";
 	PrintHeader(*pktHdr, *mailHdr);
     }
-    bcopy(mail->data, data, mail->mailHdr.length);
+    bcopy(mail.data, data, mail.mailHdr.length);
 					// copy the message data into
 					// the caller's buffer
-    delete mail;			// we've copied out the stuff we
-					// need, we can now discard the message
 }
 
 //----------------------------------------------------------------------
@@ -31,7 +31,7 @@
 #include "utility.h"
 #include "callback.h"
 #include "network.h"
-#include "synchlist.h"
+#include "synchring.h"
 #include "synch.h"
 
 // Mailbox address -- uniquely identifies a mailbox on a given machine.
@@ -64,6 +64,7 @@ class MailHeader {
 
 class Mail {
   public:
+     Mail() {}			// an empty slot in a mailbox
      Mail(PacketHeader pktH, MailHeader mailH, char *msgData);
 				// Initialize a mail message by
 				// concatenating the headers to the data
@@ -77,6 +78,14 @@ class Mail {
 // for messages.   Incoming messages are put by the PostOffice into the 
 // appropriate mailbox, and these messages can then be retrieved by
 // threads on this machine.
+//
+// A mailbox holds MailBoxSize messages in place; what arrives while
+// it is full waits, in arrival order, on an overflow list, so that no
+// message is lost.  The postal worker never waits for a receiver to
+// make room; it only waits, briefly, for the mailbox's lock while a
+// receiver is moving held mail in.
+
+#define MailBoxSize	32
 
 class MailBox {
   public: 
@@ -90,7 +99,10 @@ class MailBox {
 				// mailbox (and wait if there is no message 
 				// to get!)
   private:
-    SynchList<Mail *> *messages; // A mailbox is just a list of arrived messages
+    SynchRing<Mail> *messages;	// A mailbox is just a queue of arrived
+				// messages
+    List<Mail *> *overflow;	// messages that came while it was full
+    Lock *lock;			// keeps "overflow" behind "messages"
 };
 
 // The following two classes defines a "Post Office", or a collection of 
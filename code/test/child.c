@@ -0,0 +1,12 @@
+/* child.c
+ *	Does nothing but exit with status 7; started over and over by
+ *	spawn.c.
+ */
+
+#include "syscall.h"
+
+int
+main()
+{
+    Exit(7);
+}
@@ -0,0 +1,39 @@
+/* hugepage.c
+ *	Benchmark for large page mappings.
+ *
+ *	Sweeps a big array touching one word per page, so that every
+ *	reference goes to a different page.  With ordinary pages each
+ *	one needs its own page table entry (and TLB entry); with large
+ *	pages a whole region shares one.  Compare the "Paging" and
+ *	"Translation" lines printed at halt by
+ *
+ *		nachos -e ../test/hugepage
+ *		nachos -hp -e ../test/hugepage
+ *
+ *	once with the default page table, and once with a kernel built
+ *	with USE_TLB (TLB misses are only counted then).
+ */
+
+#include "syscall.h"
+
+#define PageWords	32		/* 128-byte pages */
+#define Pages		48
+#define Passes		20
+
+int A[Pages * PageWords];
+
+int
+main()
+{
+    int pass, i, sum = 0;
+
+    for (pass = 0; pass < Passes; pass++)
+	for (i = 0; i < Pages * PageWords; i += PageWords)
+	    A[i] += pass;
+
+    for (i = 0; i < Pages * PageWords; i += PageWords)
+	sum += A[i];
+    PrintInt(sum);
+    Halt();
+    /* not reached */
+}
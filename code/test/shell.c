@@ -4,10 +4,10 @@ int
 main()
 {
     SpaceId newProc;
-    OpenFileId input = ConsoleInput;
-    OpenFileId output = ConsoleOutput;
+    OpenFileId input = SysConsoleInput;
+    OpenFileId output = SysConsoleOutput;
     char prompt[2], ch, buffer[60];
-    int i;
+    int i, background;
 
     prompt[0] = '-';
     prompt[1] = '-';
@@ -26,9 +26,18 @@ main()
 
 	buffer[--i] = '\0';
 
+	background = 0;
+	if( i > 0 && buffer[i - 1] == '&' ) {	/* "prog &": don't wait */
+		buffer[--i] = '\0';
+		background = 1;
+	}
+
 	if( i > 0 ) {
 		newProc = Exec(buffer);
-		Join(newProc);
+		if( newProc < 0 )
+			Write("No such program\n", 16, output);
+		else if( !background )
+			Join(newProc);
 	}
     }
 }
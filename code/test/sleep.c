@@ -0,0 +1,28 @@
+/* sleep.c
+ *	Test program for the Sleep system call.
+ *
+ *	Sleeps for a growing number of ticks, printing the iteration
+ *	before each nap.  Run two copies with different priorities,
+ *	e.g.
+ *
+ *		nachos -ep ../test/sleep 60 -ep ../test/t1 40
+ *
+ *	and the sleeper's lines should be spread out over the run of
+ *	the other program instead of all coming first; with "-tl" the
+ *	timer keeps running only while somebody is asleep or needs to
+ *	be time-sliced.
+ */
+
+#include "syscall.h"
+
+int
+main()
+{
+    int i;
+
+    for (i = 1; i <= 5; i++) {
+	PrintInt(i);
+	Sleep(i * 1000);
+    }
+    Exit(0);
+}
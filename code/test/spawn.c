@@ -0,0 +1,60 @@
+/* spawn.c
+ *	Test program for the Exec, Join and ThreadFork system calls.
+ *
+ *	Starts Rounds batches of Batch copies of ../test/child, and
+ *	waits for each batch, printing the sum of the exit statuses
+ *	(Batch * 7 if all went well).  The child's file is read only
+ *	once, by the first Exec; "-d a" shows the text cache hits for
+ *	the others.  Then forks a few threads in this
+ *	address space, which each add up the same array and exit with
+ *	the sum, and joins them.
+ *
+ *		nachos -e ../test/spawn
+ */
+
+#include "syscall.h"
+
+#define Rounds	5
+#define Batch	4
+#define Workers	4
+#define Size	256
+
+int data[Size];		/* shared by all the threads */
+
+void
+Worker()
+{
+    int i, sum = 0;
+
+    for (i = 0; i < Size; i++)
+	sum += data[i];
+    ThreadExit(sum);	/* there is nothing to return to */
+}
+
+int
+main()
+{
+    SpaceId kids[Batch];
+    ThreadId workers[Workers];
+    int round, i, total;
+
+    for (round = 0; round < Rounds; round++) {
+	for (i = 0; i < Batch; i++)
+	    kids[i] = Exec("../test/child");
+	total = 0;
+	for (i = 0; i < Batch; i++)
+	    total += Join(kids[i]);
+	PrintInt(total);
+    }
+    PrintInt(Join(Exec("../test/nosuchprogram")));	/* -1 */
+
+    for (i = 0; i < Size; i++)
+	data[i] = i;
+    for (i = 0; i < Workers; i++)
+	workers[i] = ThreadFork(Worker);
+    total = 0;
+    for (i = 0; i < Workers; i++)
+	total += ThreadJoin(workers[i]);
+    PrintInt(total);	/* Workers * Size * (Size - 1) / 2 */
+    Exit(0);
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# sweep.sh
+#	Run a workload once for every combination of time slice and
+#	aging interval, and print one line per run with the throughput
+#	and the scheduling latency percentiles.  Used to tune the
+#	scheduler parameters (see threads/schedconfig.h).
+#
+#	Run from the test directory, after building nachos and the
+#	workload programs ("make sweep" does both).  The grid and the
+#	workload can be changed from the environment:
+#
+#	    QUANTA	time slices to try, in ticks
+#	    AGING	aging intervals to try, in ticks
+#	    WORKLOAD	nachos flags that start the user programs
+#	    SCHED	scheduling policy
+#	    NACHOS	the nachos binary
+#
+#	Throughput is user programs finished per 100000 ticks.
+
+NACHOS=${NACHOS:-../build.linux/nachos}
+QUANTA=${QUANTA:-"50 110 200 500"}
+AGING=${AGING:-"500 1500 3000"}
+WORKLOAD=${WORKLOAD:-"-ep t1 20 -ep t2 60 -ep t1 110 -ep t2 130"}
+SCHED=${SCHED:-mlfq}
+
+PROGS=`echo $WORKLOAD | tr ' ' '\n' | grep -c '^-ep\{0,1\}$'`
+
+echo "sched quantum aging ticks throughput p50 p95 p99 fairness"
+for q in $QUANTA; do
+    for a in $AGING; do
+	out=`$NACHOS -sched $SCHED -st off -sp quantum=$q -sp aging=$a \
+		$WORKLOAD 2>&1`
+	ticks=`echo "$out" | sed -n 's/^Ticks: total \([0-9]*\),.*/\1/p'`
+	sched=`echo "$out" | grep '^Scheduling:'`
+	p50=`echo "$sched" | sed -n 's/.* p50 \([0-9]*\),.*/\1/p'`
+	p95=`echo "$sched" | sed -n 's/.* p95 \([0-9]*\),.*/\1/p'`
+	p99=`echo "$sched" | sed -n 's/.* p99 \([0-9]*\),.*/\1/p'`
+	fair=`echo "$sched" | sed -n 's/.* fairness \([0-9.e-]*\)$/\1/p'`
+	if [ -z "$ticks" ]; then
+	    echo "$SCHED $q $a failed"
+	    continue
+	fi
+	tput=`echo "$PROGS $ticks" | awk '{ printf "%.3f", $1 * 100000 / $2 }'`
+	echo "$SCHED $q $a $ticks $tput $p50 $p95 $p99 $fair"
+    done
+done
@@ -1,8 +1,7 @@
 // alarm.cc
 //	Routines to use a hardware timer device to provide a
-//	software alarm clock.  For now, we just provide time-slicing.
-//
-//	Not completely implemented.
+//	software alarm clock: time-slicing, and putting threads to
+//	sleep for a while.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -11,6 +10,7 @@
 #include "copyright.h"
 #include "alarm.h"
 #include "main.h"
+#include "frametable.h"
 
 //----------------------------------------------------------------------
 // Alarm::Alarm
@@ -18,17 +18,22 @@
 //
 //      "doRandom" -- if true, arrange for the hardware interrupts to
 //		occur at random, instead of fixed, intervals.
+//      "quantum" is the (average) length of a time slice, in ticks
+//      "noTicks" -- if true, stop the timer while nothing needs to be
+//		time-sliced.
 //----------------------------------------------------------------------
 
-Alarm::Alarm(bool doRandom)
+Alarm::Alarm(bool doRandom, int quantum, bool noTicks)
 {
-    timer = new Timer(doRandom, this);
+    tickless = noTicks;
+    sleepers = new TimerWheel(kernel->stats->totalTicks);
+    timer = new Timer(doRandom, quantum, this);
 }
 
 //----------------------------------------------------------------------
 // Alarm::CallBack
 //	Software interrupt handler for the timer device. The timer device is
-//	set up to interrupt the CPU periodically (once every TimerTicks).
+//	set up to interrupt the CPU periodically (once every time slice).
 //	This routine is called each time there is a timer interrupt,
 //	with interrupts disabled.
 //
@@ -39,8 +44,14 @@ Alarm::Alarm(bool doRandom)
 //	if the interrupted thread called Yield at the point it is
 //	was interrupted.
 //
-//	For now, just provide time-slicing.  Only need to time slice
-//      if we're currently running something (in other words, not idle).
+//	First wake up every sleeper whose time has come.  Then time
+//	slice; only need to time slice if we're currently running
+//	something (in other words, not idle).
+//	We also let the core map sample the page reference bits, to
+//	keep the working set estimates up to date.
+//
+//	In tickless mode, stop the timer if the next interrupt would
+//	have nothing to slice and nobody to wake up.
 //----------------------------------------------------------------------
 
 void
@@ -48,8 +59,57 @@ Alarm::CallBack()
 {
     Interrupt *interrupt = kernel->interrupt;
     MachineStatus status = interrupt->getStatus();
+    List<Thread *> woken;
+
+    sleepers->Advance(kernel->stats->totalTicks, &woken);
+    while (!woken.IsEmpty())
+	kernel->scheduler->ReadyToRun(woken.RemoveFront());
+
+    kernel->frameTable->SampleReferences();
 
     if (status != IdleMode) {
 	interrupt->YieldOnReturn();
     }
+    if (tickless && sleepers->IsEmpty() &&
+	    (status == IdleMode || !kernel->scheduler->NeedsTimeSlice()))
+	timer->Suspend();	// nobody to slice; CheckTimer resumes it
+}
+
+//----------------------------------------------------------------------
+// Alarm::WaitUntil
+//	Put the current thread to sleep for at least "x" ticks.  It is
+//	woken up by the first timer interrupt at or after that time, so
+//	it may sleep up to a time slice longer.
+//
+//	"x" is how long to sleep, in ticks
+//----------------------------------------------------------------------
+
+void
+Alarm::WaitUntil(int x)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    if (x > 0) {
+	DEBUG(dbgThread, "Sleeping thread: " << kernel->currentThread->getName()
+		<< " for " << x << " ticks");
+	sleepers->Insert(kernel->currentThread, kernel->stats->totalTicks + x);
+	if (timer->IsSuspended())
+	    timer->Resume();		// somebody has to wake us up
+	kernel->currentThread->Sleep(FALSE);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Alarm::CheckTimer
+//	Called by the scheduler when a thread becomes ready or starts
+//	running.  In tickless mode, restart the timer if it was stopped
+//	and there is something to time-slice again.
+//----------------------------------------------------------------------
+
+void
+Alarm::CheckTimer()
+{
+    if (tickless && timer->IsSuspended() && kernel->scheduler->NeedsTimeSlice())
+	timer->Resume();
 }
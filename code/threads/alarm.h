@@ -8,7 +8,17 @@
 //	From this, we provide the ability for a thread to be
 //	woken up after a delay; we also provide time-slicing.
 //
-//	NOTE: this abstraction is not completely implemented.
+//	Sleeping threads are kept on a timer wheel (see timerwheel.h),
+//	which every timer interrupt moves up to the current time; the
+//	threads whose time has come are put back on the ready queue.
+//
+//	In tickless mode, the timer is stopped whenever a time slice
+//	could not make any difference -- nothing is ready, or the
+//	running thread may not be sliced -- and started again by the
+//	scheduler when that changes.  Simulations that are mostly
+//	waiting for I/O then skip the timer interrupts altogether.
+//	The use bits are sampled less often then, too.  The timer is
+//	never stopped while somebody is asleep.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -21,20 +31,26 @@
 #include "utility.h"
 #include "callback.h"
 #include "timer.h"
+#include "timerwheel.h"
 
 // The following class defines a software alarm clock.
 class Alarm : public CallBackObj {
   public:
 
-    Alarm(bool doRandomYield);	// Initialize the timer, and callback
+    Alarm(bool doRandomYield, int quantum, bool tickless);
+				// Initialize the timer, and callback
 				// to "toCall" every time slice.
-    ~Alarm() { delete timer; }
+    ~Alarm() { delete timer; delete sleepers; }
 
-    void WaitUntil(int x);	// suspend execution until time > now + x
-                                // this method is not yet implemented
+    void WaitUntil(int x);	// suspend execution until time >= now + x
+    void CheckTimer();		// The ready queue or the running thread
+				// changed; restart the timer if a time
+				// slice is needed again
 
   private:
     Timer *timer;		// the hardware timer device
+    bool tickless;		// stop the timer when it is not needed
+    TimerWheel *sleepers;	// threads waiting in WaitUntil
 
     void CallBack();		// called when the hardware
 				// timer generates an interrupt
@@ -12,11 +12,15 @@
 #include "sysdep.h"
 #include "synch.h"
 #include "synchlist.h"
+#include "synchring.h"
 #include "libtest.h"
 #include "string.h"
 #include "synchdisk.h"
 #include "post.h"
 #include "synchconsole.h"
+#include "frametable.h"
+#include "textcache.h"
+#include "interruptheap.h"
 
 //----------------------------------------------------------------------
 // Kernel::Kernel
@@ -27,9 +31,23 @@
 Kernel::Kernel(int argc, char **argv)
 {
     randomSlice = FALSE;
+    tickless = FALSE;
+    profileSynch = FALSE;
+    synchProfiler = NULL;		// not there until Initialize
     debugUserProg = FALSE;
     consoleIn = NULL;          // default is stdin
     consoleOut = NULL;         // default is stdout
+    residentLimit = NumPhysPages;	// default is no per-process limit
+    workingSetWindow = WorkingSetWindow;
+    largePages = FALSE;
+    pagingReport = FALSE;		// unless paging is tuned
+    schedPolicy = "mlfq";		// MP3 multilevel feedback queue
+    schedTraceFile = "text";		// print scheduler events as before
+    schedMetricsFile = NULL;		// print scheduler metrics only
+    schedConfig = new SchedConfig();	// MP3 parameters, unless changed
+    threadPoolSize = ThreadPoolSize;
+    execFiles = new List<char *>;
+    execPriorities = new List<int>;
 
 #ifndef FILESYS_STUB
     formatFlag = FALSE;
@@ -46,17 +64,24 @@ Kernel::Kernel(int argc, char **argv)
 	    	i++;
         } else if (strcmp(argv[i], "-s") == 0) {
             debugUserProg = TRUE;
+        } else if (strcmp(argv[i], "-tl") == 0) {
+            tickless = TRUE;
+        } else if (strcmp(argv[i], "-lp") == 0) {
+            profileSynch = TRUE;
 		} else if (strcmp(argv[i], "-e") == 0) {
-        	execfile[++execfileNum]= argv[++i];
-			cout << execfile[execfileNum] << "\n";
+	    	ASSERT(i + 1 < argc);
+        	execFiles->Append(argv[++i]);
+        	execPriorities->Append(0);
+			cout << argv[i] << "\n";
 		}
 
         /* MP3 */
         else if (strcmp(argv[i], "-ep") == 0)
         {
-        	execfile[++execfileNum]= argv[++i];
-            execpriority[++execpriorityNum] = atoi(argv[++i]);
-			cout << execfile[execfileNum] << "\n";
+	    	ASSERT(i + 2 < argc);
+        	execFiles->Append(argv[++i]);
+            execPriorities->Append(atoi(argv[++i]));
+			cout << argv[i - 1] << "\n";
 		}
 
         else if (strcmp(argv[i], "-ci") == 0) {
@@ -79,6 +104,45 @@ Kernel::Kernel(int argc, char **argv)
             ASSERT(i + 1 < argc);   // next argument is int
             hostName = atoi(argv[i + 1]);
             i++;
+        } else if (strcmp(argv[i], "-rss") == 0) {
+            ASSERT(i + 1 < argc);   // max resident pages per process
+            residentLimit = atoi(argv[i + 1]);
+            ASSERT(residentLimit > 0);
+            pagingReport = TRUE;
+            i++;
+        } else if (strcmp(argv[i], "-ws") == 0) {
+            ASSERT(i + 1 < argc);   // working set window, in ticks
+            workingSetWindow = atoi(argv[i + 1]);
+            pagingReport = TRUE;
+            i++;
+        } else if (strcmp(argv[i], "-hp") == 0) {
+            largePages = TRUE;
+            pagingReport = TRUE;
+        } else if (strcmp(argv[i], "-sched") == 0) {
+            ASSERT(i + 1 < argc);   // name of the scheduling policy
+            schedPolicy = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-st") == 0) {
+            ASSERT(i + 1 < argc);   // off, text, or a trace file
+            schedTraceFile = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-sc") == 0) {
+            ASSERT(i + 1 < argc);   // file of scheduler parameters
+            schedConfig->Load(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "-sp") == 0) {
+            ASSERT(i + 1 < argc);   // one scheduler parameter
+            if (!schedConfig->Set(argv[i + 1]))
+                cout << "Unknown scheduler parameter " << argv[i + 1] << "\n";
+            i++;
+        } else if (strcmp(argv[i], "-tp") == 0) {
+            ASSERT(i + 1 < argc);   // free stacks to keep; 0 for none
+            threadPoolSize = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "-sm") == 0) {
+            ASSERT(i + 1 < argc);   // CSV file for scheduler metrics
+            schedMetricsFile = argv[i + 1];
+            i++;
         } else if (strcmp(argv[i], "-u") == 0) {
             cout << "Partial usage: nachos [-rs randomSeed]\n";
 	   		cout << "Partial usage: nachos [-s]\n";
@@ -87,8 +151,17 @@ Kernel::Kernel(int argc, char **argv)
 	    	cout << "Partial usage: nachos [-nf]\n";
 #endif
             cout << "Partial usage: nachos [-n #] [-m #]\n";
+            cout << "Partial usage: nachos [-rss pages] [-ws ticks] [-hp]\n";
+            cout << "Partial usage: nachos [-sched mlfq|rr|cfs|lottery|stride]\n";
+            cout << "Partial usage: nachos [-st off|text|traceFile]\n";
+            cout << "Partial usage: nachos [-sm csvFile]\n";
+            cout << "Partial usage: nachos [-sc configFile] [-sp key=value]\n";
+            cout << "Partial usage: nachos [-tl]\n";
+            cout << "Partial usage: nachos [-tp poolSize]\n";
+            cout << "Partial usage: nachos [-lp]\n";
 		}
     }
+    schedConfig->Check();
 }
 
 //----------------------------------------------------------------------
@@ -101,32 +174,40 @@ Kernel::Kernel(int argc, char **argv)
 void
 Kernel::Initialize()
 {
+    stats = new Statistics();		// collect statistics
+    if (profileSynch)			// before any semaphore or lock
+	synchProfiler = new SynchProfiler();
+    schedMetrics = new SchedMetrics(schedMetricsFile);
+    threadPool = new ThreadPool(threadPoolSize);
+    threadTable = new ThreadTable();
+
     // We didn't explicitly allocate the current thread we are running in.
     // But if it ever tries to give up the CPU, we better have a Thread
     // object to save its state.
 
-
-    currentThread = new Thread("main", threadNum++);
+    currentThread = new Thread("main", 0);
     currentThread->setStatus(RUNNING);
 
-    stats = new Statistics();		// collect statistics
     interrupt = new Interrupt;		// start up interrupt handling
-    scheduler = new Scheduler();	// initialize the ready queue
-    alarm = new Alarm(randomSlice);	// start up time slicing
+    schedTrace = new SchedTrace(schedTraceFile);
+    scheduler = new Scheduler(schedPolicy, schedConfig);	// initialize the ready queue
+    alarm = new Alarm(randomSlice, schedConfig->quantum, tickless);	// start up time slicing
     machine = new Machine(debugUserProg);
     synchConsoleIn = new SynchConsoleInput(consoleIn); // input from stdin
     synchConsoleOut = new SynchConsoleOutput(consoleOut); // output to stdout
     synchDisk = new SynchDisk();    //
 
-    // MP2 Initilize freeFrameList
-    freeFrameList = new List<int>;
-    for(int i=0 ; i<NumPhysPages ; i++) freeFrameList->Append(i);
+    // MP2 Initilize the core map
+    frameTable = new FrameTable(residentLimit, workingSetWindow,
+    				largePages);
+    textCache = new TextCache(TextCacheSize);
 
 #ifdef FILESYS_STUB
     fileSystem = new FileSystem();
 #else
     fileSystem = new FileSystem(formatFlag);
 #endif // FILESYS_STUB
+    openFileLock = new RWLock("open file table");
     postOfficeIn = new PostOfficeInput(10);
     postOfficeOut = new PostOfficeOutput(reliability);
 
@@ -143,27 +224,69 @@ Kernel::~Kernel()
     delete stats;
     delete interrupt;
     delete scheduler;
+    delete schedTrace;			// writes out the rest of the trace
+    delete schedMetrics;
+    delete schedConfig;
     delete alarm;
     delete machine;
     delete synchConsoleIn;
     delete synchConsoleOut;
     delete synchDisk;
+    delete frameTable;
+    delete textCache;
+    delete openFileLock;
     delete fileSystem;
     delete postOfficeIn;
     delete postOfficeOut;
+    delete threadTable;
+    delete execFiles;
+    delete execPriorities;
+    delete threadPool;
+    delete synchProfiler;
 
     Exit(0);
 }
 
+//----------------------------------------------------------------------
+// Kernel::Report
+// 	Print, at halt, the reports of the features turned on on the
+//	command line: paging (-rss, -ws, -hp, or -d a), the timer
+//	(-tl), scheduling latency and fairness (-sm), the object pools
+//	(-d p) and the synchronization profile (-lp).  Without any of
+//	them, nothing is printed beyond the usual statistics.
+//----------------------------------------------------------------------
+
+void
+Kernel::Report()
+{
+    if (pagingReport || debug->IsEnabled(dbgAddr)) {
+	stats->PrintPaging();
+	frameTable->Print();
+    }
+    if (tickless)
+	cout << "Timer: interrupts " << stats->numTimerInterrupts << "\n";
+    if (schedMetricsFile != NULL)
+	schedMetrics->Print();
+    if (debug->IsEnabled(dbgPool))
+	ObjectPool::PrintAll();
+    if (synchProfiler != NULL)
+	synchProfiler->Print();
+}
+
 //----------------------------------------------------------------------
 // Kernel::ThreadSelfTest
-//      Test threads, semaphores, synchlists
+//      Test threads, semaphores, synchlists, lock priority inheritance,
+//      reader-writer locks
 //----------------------------------------------------------------------
 
 void
 Kernel::ThreadSelfTest() {
    Semaphore *semaphore;
    SynchList<int> *synchList;
+   SynchRing<int> *synchRing;
+   Lock *lock;
+   Condition *condition;
+   RWLock *rwLock;
 
    LibSelfTest();		// test library routines
 
@@ -180,6 +303,212 @@ Kernel::ThreadSelfTest() {
    synchList->SelfTest(9);
    delete synchList;
 
+   				// and bounded rings
+   synchRing = new SynchRing<int>(4);
+   synchRing->SelfTest(9);
+   delete synchRing;
+
+   				// test handing the lock over in Wait
+   condition = new Condition("test");
+   condition->SelfTest();
+   delete condition;
+
+   				// test priority inheritance
+   lock = new Lock("test");
+   lock->SelfTest();
+   delete lock;
+
+   				// test reader-writer locks
+   rwLock = new RWLock("test");
+   rwLock->SelfTest();
+   delete rwLock;
+
+}
+
+//----------------------------------------------------------------------
+// Kernel::ForkBenchmark
+//      Fork "n" threads that do nothing but finish, one after the
+//      other, and print how many forks per second of host time that
+//      came to.  Comparing with a run with "-tp 0", which allocates
+//      every stack and Thread afresh, shows what the thread pool
+//      saves.  Best run with "-st off", so that the scheduler trace
+//      is not timed along.
+//----------------------------------------------------------------------
+
+static void
+ForkBenchmarkThread(Semaphore *done)
+{
+    done->V();
+}
+
+void
+Kernel::ForkBenchmark(int n)
+{
+    Semaphore *done = new Semaphore("fork benchmark", 0);
+    Thread *thread;
+    double start, elapsed;
+
+    start = HostTime();
+    for (int i = 0; i < n; i++) {
+	thread = new Thread("forked", threadTable->Allocate());
+	threadTable->Enter(thread);
+	thread->Fork((VoidFunctionPtr) ForkBenchmarkThread, (void *) done);
+	done->P();
+    }
+    elapsed = HostTime() - start;
+    delete done;
+
+    cout << "Fork benchmark: " << n << " threads in " << elapsed
+	<< " seconds, " << (elapsed > 0 ? n / elapsed : 0.0)
+	<< " forks per second\n";
+    threadPool->Print();
+}
+
+//----------------------------------------------------------------------
+// Kernel::BroadcastBenchmark
+//      Have "n" threads wait on one condition variable, wake them all
+//      with Broadcast, and do it again, HerdRounds times.  Every woken
+//      thread needs the lock, so this is where a thundering herd
+//      would fight over it.  Prints the host time taken and the
+//      number of context switches per wakeup: with waiters moved
+//      onto the queue of the lock, each of them runs exactly once
+//      per wakeup, already holding the lock, for about one switch.
+//----------------------------------------------------------------------
+
+static const int HerdRounds = 100;
+
+static Lock *herdLock;
+static Condition *herdGo;
+static int herdRound;			// rounds started so far
+static int herdWaiting;			// threads waiting this round
+static Semaphore *herdAllIn;		// V'ed when all "n" are waiting
+static Semaphore *herdDone;		// V'ed by each thread at the end
+
+static void
+HerdThread(int n)
+{
+    for (int round = 1; round <= HerdRounds; round++) {
+	herdLock->Acquire();
+	if (++herdWaiting == n)
+	    herdAllIn->V();
+	while (herdRound < round)
+	    herdGo->Wait(herdLock);
+	herdLock->Release();
+    }
+    herdDone->V();
+}
+
+void
+Kernel::BroadcastBenchmark(int n)
+{
+    int switches;
+    double start, elapsed;
+
+    herdLock = new Lock("herd");
+    herdGo = new Condition("herd go");
+    herdAllIn = new Semaphore("herd all in", 0);
+    herdDone = new Semaphore("herd done", 0);
+    herdRound = 0;
+    herdWaiting = 0;
+    for (int i = 0; i < n; i++)
+	(new Thread("herd", 1))->Fork((VoidFunctionPtr) HerdThread,
+					(void *) n);
+
+    start = HostTime();
+    switches = scheduler->NumSwitches();
+    for (int round = 1; round <= HerdRounds; round++) {
+	herdAllIn->P();
+	herdLock->Acquire();
+	herdWaiting = 0;
+	herdRound = round;
+	herdGo->Broadcast(herdLock);
+	herdLock->Release();
+    }
+    herdDone->P(n);
+    elapsed = HostTime() - start;
+    switches = scheduler->NumSwitches() - switches;
+
+    cout << "Broadcast benchmark: " << HerdRounds << " rounds of " << n
+	<< " waiters in " << elapsed << " seconds, "
+	<< (double) switches / (HerdRounds * n)
+	<< " context switches per wakeup\n";
+    delete herdDone;
+    delete herdAllIn;
+    delete herdGo;
+    delete herdLock;
+}
+
+//----------------------------------------------------------------------
+// Kernel::EventBenchmark
+//      Time the queue of pending interrupts with "n" of them
+//      outstanding, the "hold" model of event simulation: take the
+//      earliest interrupt off, and schedule it again a random time
+//      later, EventRounds times.  The same is done with a SortedList,
+//      the way the queue used to be kept, for comparison; both get
+//      the same pseudo-random times.  The times are spread over "n"
+//      ticks, so many interrupts are due at once; the heap is first
+//      checked to fire those in the order they were scheduled.
+//
+//      Only the queues are timed: the interrupts are reused, not
+//      allocated, and nothing is called back.
+//----------------------------------------------------------------------
+
+static const int EventRounds = 200000;
+
+static int
+EventCompare(PendingInterrupt *x, PendingInterrupt *y)
+{
+    if (x->when != y->when)
+	return (x->when < y->when) ? -1 : 1;
+    return 0;
+}
+
+template <class Queue>
+static double
+EventHold(Queue *queue, int n)
+{
+    PendingInterrupt *pending;
+    double start, elapsed;
+    int now = 0;
+
+    RandomInit(n);			// the same times for every queue
+    for (int i = 0; i < n; i++)
+	queue->Insert(new PendingInterrupt(NULL, RandomNumber() % n,
+					TimerInt));
+    start = HostTime();
+    for (int i = 0; i < EventRounds; i++) {
+	pending = queue->RemoveFront();
+	ASSERT(pending->when >= now);
+	now = pending->when;
+	pending->when = now + 1 + RandomNumber() % n;
+	queue->Insert(pending);
+    }
+    elapsed = HostTime() - start;
+    while (!queue->IsEmpty())
+	delete queue->RemoveFront();
+    return elapsed;
+}
+
+void
+Kernel::EventBenchmark(int n)
+{
+    InterruptHeap *heap = new InterruptHeap();
+    SortedList<PendingInterrupt *> *list =
+			new SortedList<PendingInterrupt *>(EventCompare);
+    double heapTime, listTime;
+
+    heap->SelfTest(100);
+    heapTime = EventHold(heap, n);
+    listTime = EventHold(list, n);
+
+    cout << "Event benchmark: " << EventRounds << " events with " << n
+	<< " outstanding; 4-ary heap " << heapTime << " seconds ("
+	<< (heapTime > 0 ? EventRounds / heapTime : 0.0)
+	<< " events per second), sorted list " << listTime << " seconds ("
+	<< (listTime > 0 ? EventRounds / listTime : 0.0)
+	<< " events per second)\n";
+    delete heap;
+    delete list;
 }
 
 //----------------------------------------------------------------------
@@ -276,12 +605,9 @@ void ForkExecute(Thread *t)
 
 void Kernel::ExecAll()
 {
-    /* MP3 threadNum conflict with postal */
-    threadNum = 2;
-
-    for (int i=1;i<=execfileNum;i++) {
-		int a = Exec(execfile[i], execpriority[i]);
-	}
+    /* MP3 thread IDs start at FirstThreadID, clear of the postal worker */
+    while (!execFiles->IsEmpty())
+		Exec(execFiles->RemoveFront(), execPriorities->RemoveFront());
 	currentThread->Finish();
     //Kernel::Exec();
 }
@@ -289,12 +615,13 @@ void Kernel::ExecAll()
 
 int Kernel::Exec(char* name, int priority)
 {
-	t[threadNum] = new Thread(name, threadNum, priority);
-	t[threadNum]->space = new AddrSpace();
-	t[threadNum]->Fork((VoidFunctionPtr) &ForkExecute, (void *)t[threadNum]);
-	threadNum++;
+	Thread *thread = new Thread(name, threadTable->Allocate(), priority);
+
+	threadTable->Enter(thread);
+	thread->space = new AddrSpace();
+	thread->Fork((VoidFunctionPtr) &ForkExecute, (void *)thread);
 
-	return threadNum-1;
+	return thread->getID();
 /*
     cout << "Total threads number is " << execfileNum << endl;
     for (int n=1;n<=execfileNum;n++) {
@@ -322,6 +649,55 @@ int Kernel::Exec(char* name, int priority)
 //  cout << "after ThreadedKernel:Run();" << endl;  // unreachable
 }
 
+//----------------------------------------------------------------------
+// Kernel::ThreadFork
+// 	Start a new thread running the user function at address "func",
+//	in the address space of the current thread, on a stack of its
+//	own.  The new thread gets an ID like a program does, so that it
+//	can be joined.  Returns the ID, or -1 if there is no room for
+//	another stack.
+//----------------------------------------------------------------------
+
+class UserThreadStart {
+  public:
+    int func;			// where the new thread starts
+    int stackTop;		// and its stack
+};
+
+static void
+ForkUserThread(UserThreadStart *start)
+{
+    int func = start->func;
+    int stackTop = start->stackTop;
+
+    delete start;
+    kernel->currentThread->space->ExecuteThread(func, stackTop);
+}
+
+int
+Kernel::ThreadFork(int func)
+{
+    AddrSpace *space = currentThread->space;
+    UserThreadStart *start;
+    Thread *thread;
+
+    ASSERT(space != NULL);
+    start = new UserThreadStart;
+    start->func = func;
+    start->stackTop = space->AddStack();
+    if (start->stackTop < 0) {
+	delete start;
+	return -1;
+    }
+    thread = new Thread(currentThread->getName(), threadTable->Allocate(),
+			currentThread->getPriority());
+    threadTable->Enter(thread);
+    space->Attach();
+    thread->space = space;
+    thread->Fork((VoidFunctionPtr) ForkUserThread, (void *) start);
+    return thread->getID();
+}
+
 int Kernel::CreateFile(char *filename)
 {
 	return fileSystem->Create(filename);
@@ -362,7 +738,9 @@ void Kernel::PrintInt(int n)
 
 int Kernel::Open(char *filename)
 {
+    openFileLock->AcquireWrite();	// Open adds to the table
     OpenFile* file = fileSystem->Open(filename);
+    openFileLock->ReleaseWrite();
     if(file == NULL) return -1;
     return (int)(file);
 }
@@ -370,33 +748,48 @@ int Kernel::Open(char *filename)
 int Kernel::Write(char* buffer , int size , int id)
 {
     OpenFile* file = (OpenFile*) id;
-    for(int i=0 ; i < fileSystem->openFileTableTop ; i++)
-        if(fileSystem->openFileTable[i] == file)
-            return file->Write(buffer, size);
-    return -1;
+    int result = -1;
+
+    openFileLock->AcquireRead();	// readers and writers of files
+    for(int i=0 ; i < fileSystem->openFileTableTop ; i++)  // share it
+        if(fileSystem->openFileTable[i] == file) {
+            result = file->Write(buffer, size);
+            break;
+        }
+    openFileLock->ReleaseRead();
+    return result;
 }
 
 int Kernel::Read(char* buffer , int size , int id)
 {
     OpenFile* file = (OpenFile*) id;
+    int result = -1;
+
+    openFileLock->AcquireRead();
     for(int i=0 ; i < fileSystem->openFileTableTop ; i++)
-        if(fileSystem->openFileTable[i] == file)
-            return file->Read(buffer, size);
-    return -1;
+        if(fileSystem->openFileTable[i] == file) {
+            result = file->Read(buffer, size);
+            break;
+        }
+    openFileLock->ReleaseRead();
+    return result;
 }
 
 int Kernel::Close(int id)
 {
     OpenFile* file = (OpenFile*) id;
+    openFileLock->AcquireWrite();
     for(int i=0 ; i < fileSystem->openFileTableTop ; i++)
     {
         if(fileSystem->openFileTable[i] == file)
         {
             fileSystem->openFileTable[i] = fileSystem->openFileTable[fileSystem->openFileTableTop-1];
             fileSystem->openFileTableTop--;
+            openFileLock->ReleaseWrite();
             delete file;
             return 1;
         }
     }
+    openFileLock->ReleaseWrite();
     return 0;
 }
@@ -13,6 +13,12 @@
 #include "utility.h"
 #include "thread.h"
 #include "scheduler.h"
+#include "schedtrace.h"
+#include "schedmetrics.h"
+#include "schedconfig.h"
+#include "synchprof.h"
+#include "threadpool.h"
+#include "threadtable.h"
 #include "interrupt.h"
 #include "stats.h"
 #include "alarm.h"
@@ -24,6 +30,9 @@ class PostOfficeOutput;
 class SynchConsoleInput;
 class SynchConsoleOutput;
 class SynchDisk;
+class FrameTable;
+class TextCache;
+class RWLock;
 
 
 
@@ -38,11 +47,19 @@ class Kernel {
 				// refers to "kernel" as a global
 	void ExecAll();
 	int Exec(char* name, int priority);
+    int ThreadFork(int func);	// run user function "func" in a new
+				// thread, in the current address space
+    void Report();		// print the reports asked for, at halt
     void ThreadSelfTest();	// self test of threads and synchronization
+    void ForkBenchmark(int n);	// time forking "n" short threads
+    void BroadcastBenchmark(int n);
+    				// time waking "n" threads at once
+    void EventBenchmark(int n);	// time the pending interrupt queue
+				// with "n" interrupts outstanding
 
     void ConsoleTest();         // interactive console self test
     void NetworkTest();         // interactive 2-machine network test
-	Thread* getThread(int threadID){return t[threadID];}
+	Thread* getThread(int threadID){return threadTable->Lookup(threadID);}
 
 	int CreateFile(char* filename); // fileSystem call
 
@@ -54,7 +71,8 @@ class Kernel {
     int Close(int id);
 
     /* MP2 */
-    List<int> *freeFrameList;
+    FrameTable *frameTable;	// physical frames and swap space
+    TextCache *textCache;	// executable files being run
 
 // These are public for notational convenience; really,
 // they're global variables used everywhere.
@@ -63,12 +81,20 @@ class Kernel {
     Scheduler *scheduler;	// the ready list
     Interrupt *interrupt;	// interrupt status
     Statistics *stats;		// performance metrics
+    SchedTrace *schedTrace;	// scheduler event log
+    SchedMetrics *schedMetrics;	// per-thread latency and fairness
+    SchedConfig *schedConfig;	// time slice, aging and MLFQ levels
+    ThreadPool *threadPool;	// free thread stacks and Thread objects
+    ThreadTable *threadTable;	// user program threads, by ID
+    SynchProfiler *synchProfiler;	// lock contention and deadlocks;
+				// NULL unless profiling (-lp)
     Alarm *alarm;		// the software alarm clock
     Machine *machine;           // the simulated CPU
     SynchConsoleInput *synchConsoleIn;
     SynchConsoleOutput *synchConsoleOut;
     SynchDisk *synchDisk;
     FileSystem *fileSystem;
+    RWLock *openFileLock;	// guards the open file table
     PostOfficeInput *postOfficeIn;
     PostOfficeOutput *postOfficeOut;
 
@@ -76,16 +102,22 @@ class Kernel {
 
   private:
 
-	Thread* t[10];
-	char*   execfile[10];
-	int execfileNum;
+	List<char *> *execFiles;	// user programs to run (-e, -ep)
 
     /* MP3 */
-    int execpriority[10];
-    int execpriorityNum;
-
-	int threadNum;
+    List<int> *execPriorities;	// and their priorities, in step
+
+    int residentLimit;		// max resident pages per process
+    int workingSetWindow;	// working set window, in ticks
+    bool largePages;		// map big regions with large pages
+    bool pagingReport;		// print paging statistics at halt
+    char *schedPolicy;		// name of the scheduling policy
+    char *schedTraceFile;	// where scheduler events go
+    char *schedMetricsFile;	// CSV file for the scheduler metrics
+    int threadPoolSize;		// free stacks and threads to keep
     bool randomSlice;		// enable pseudo-random time slicing
+    bool tickless;		// stop the timer when nothing to slice
+    bool profileSynch;		// profile the synchronization primitives
     bool debugUserProg;         // single step user program
     double reliability;         // likelihood messages are dropped
     char *consoleIn;            // file to read console input from
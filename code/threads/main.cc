@@ -7,6 +7,10 @@
 //              -f -cp <unix file> <nachos file>
 //              -p <nachos file> -r <nachos file> -l -D
 //              -n <network reliability> -m <machine id>
+//              -rss <pages> -ws <ticks> -hp -sched <policy>
+//              -st <trace file> -sd <trace file> -sm <csv file>
+//              -sc <config file> -sp <key>=<value> -tl -tp <threads>
+//              -lp -fb <threads> -cb <threads> -eb <events>
 //              -z -K -C -N
 //
 //    -d causes certain debugging messages to be printed (see debug.h)
@@ -18,6 +22,28 @@
 //    -co specify file for console output (stdout is the default)
 //    -n sets the network reliability
 //    -m sets this machine's host id (needed for the network)
+//    -rss limits the number of resident pages of each user program
+//    -ws sets the working set window, in ticks
+//    -hp maps large aligned regions of user programs with large pages
+//    -sched picks the scheduling policy: mlfq (the default), rr, cfs,
+//	lottery or stride
+//    -st sends scheduler events to a binary trace file; "off" drops
+//	them, "text" (the default) prints them as they happen
+//    -sd prints a binary scheduler trace as text, and quits
+//    -sm prints scheduling latency and fairness at halt, and writes
+//	the per-thread scheduler metrics to a CSV file
+//    -sc reads scheduler parameters (time slice, aging, MLFQ levels)
+//	from a file of key=value lines; see schedconfig.h
+//    -sp sets one scheduler parameter
+//    -tl stops the timer while there is nothing to time-slice
+//    -tp keeps up to this many free thread stacks for reuse (0: none)
+//    -lp profiles the semaphores, locks and condition variables, and
+//	reports the threads left blocked forever (deadlock) at the end
+//    -fb times forking and finishing this many threads, and quits
+//    -cb times waking this many threads waiting on a condition
+//	variable, and quits
+//    -eb times the queue of pending interrupts with this many
+//	outstanding, against a sorted list, and quits
 //    -K run a simple self test of kernel threads and synchronization
 //    -C run an interactive console test
 //    -N run a two-machine network test (see Kernel::NetworkTest)
@@ -172,6 +198,10 @@ main(int argc, char **argv)
     bool threadTestFlag = false;
     bool consoleTestFlag = false;
     bool networkTestFlag = false;
+    char *traceFileName = NULL;	      // scheduler trace to decode
+    int forkBenchmark = 0;	      // threads to fork, to time it
+    int broadcastBenchmark = 0;	      // threads to wake, to time it
+    int eventBenchmark = 0;	      // interrupts outstanding, to time
 #ifndef FILESYS_STUB
     char *copyUnixFileName = NULL;    // UNIX file to be copied into Nachos
     char *copyNachosFileName = NULL;  // name of copied file in Nachos
@@ -207,6 +237,26 @@ main(int argc, char **argv)
 	else if (strcmp(argv[i], "-N") == 0) {
 	    networkTestFlag = TRUE;
 	}
+	else if (strcmp(argv[i], "-fb") == 0) {
+	    ASSERT(i + 1 < argc);
+	    forkBenchmark = atoi(argv[i + 1]);
+	    i++;
+	}
+	else if (strcmp(argv[i], "-cb") == 0) {
+	    ASSERT(i + 1 < argc);
+	    broadcastBenchmark = atoi(argv[i + 1]);
+	    i++;
+	}
+	else if (strcmp(argv[i], "-eb") == 0) {
+	    ASSERT(i + 1 < argc);
+	    eventBenchmark = atoi(argv[i + 1]);
+	    i++;
+	}
+	else if (strcmp(argv[i], "-sd") == 0) {
+	    ASSERT(i + 1 < argc);
+	    traceFileName = argv[i + 1];
+	    i++;
+	}
 #ifndef FILESYS_STUB
 	else if (strcmp(argv[i], "-cp") == 0) {
 	    ASSERT(i + 2 < argc);
@@ -235,6 +285,9 @@ main(int argc, char **argv)
             cout << "Partial usage: nachos [-z -d debugFlags]\n";
             cout << "Partial usage: nachos [-x programName]\n";
 	    cout << "Partial usage: nachos [-K] [-C] [-N]\n";
+	    cout << "Partial usage: nachos [-sd traceFile]\n";
+	    cout << "Partial usage: nachos [-fb threads] [-cb threads]\n";
+	    cout << "Partial usage: nachos [-eb events]\n";
 #ifndef FILESYS_STUB
             cout << "Partial usage: nachos [-cp UnixFile NachosFile]\n";
             cout << "Partial usage: nachos [-p fileName] [-r fileName]\n";
@@ -245,6 +298,11 @@ main(int argc, char **argv)
     }
     debug = new Debug(debugArg);
     
+    if (traceFileName != NULL) {	// nothing to run, just decode
+      SchedTrace::Decode(traceFileName);
+      Exit(0);
+    }
+
     DEBUG(dbgThread, "Entering main");
 
     kernel = new Kernel(argc, argv);
@@ -258,6 +316,18 @@ main(int argc, char **argv)
     if (threadTestFlag) {
       kernel->ThreadSelfTest();  // test threads and synchronization
     }
+    if (forkBenchmark > 0) {
+      kernel->ForkBenchmark(forkBenchmark);
+      Exit(0);			// nothing else to run
+    }
+    if (broadcastBenchmark > 0) {
+      kernel->BroadcastBenchmark(broadcastBenchmark);
+      Exit(0);
+    }
+    if (eventBenchmark > 0) {
+      kernel->EventBenchmark(eventBenchmark);
+      Exit(0);
+    }
     if (consoleTestFlag) {
       kernel->ConsoleTest();   // interactive test of the synchronized console
     }
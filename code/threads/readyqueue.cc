@@ -0,0 +1,645 @@
+// readyqueue.cc
+//	Routines for the ready queues of the schedulers: a binary heap
+//	of threads, an array of priority buckets, and a red-black tree.
+//
+//	These routines assume that interrupts are already disabled,
+//	like the rest of the scheduler.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "readyqueue.h"
+#include "thread.h"
+#include <strings.h>
+
+// Initial number of threads a heap has room for; it doubles as needed.
+const int InitialHeapSize = 16;
+
+//----------------------------------------------------------------------
+// ThreadHeap::ThreadHeap
+// 	Initialize an empty heap.
+//
+//	"comp" orders the threads, as for a SortedList
+//----------------------------------------------------------------------
+
+ThreadHeap::ThreadHeap(int (*comp)(Thread *x, Thread *y))
+{
+    compare = comp;
+    size = InitialHeapSize;
+    items = new Thread *[size];
+    order = new int[size];
+    numInHeap = 0;
+    nextOrder = 0;
+}
+
+//----------------------------------------------------------------------
+// ThreadHeap::~ThreadHeap
+// 	De-allocate the heap.  The threads on it are not touched.
+//----------------------------------------------------------------------
+
+ThreadHeap::~ThreadHeap()
+{
+    delete [] items;
+    delete [] order;
+}
+
+//----------------------------------------------------------------------
+// ThreadHeap::Less
+// 	Return TRUE if items[i] should be removed before items[j]:
+//	it compares smaller, or equal but arrived earlier.
+//----------------------------------------------------------------------
+
+bool
+ThreadHeap::Less(int i, int j) const
+{
+    int c = (*compare)(items[i], items[j]);
+
+    if (c != 0)
+	return c < 0;
+    return order[i] < order[j];
+}
+
+//----------------------------------------------------------------------
+// ThreadHeap::Put, Swap
+// 	Store a thread at index i, keeping its heapIndex up to date;
+//	or exchange the threads at i and j.
+//----------------------------------------------------------------------
+
+void
+ThreadHeap::Put(int i, Thread *thread, int arrival)
+{
+    items[i] = thread;
+    order[i] = arrival;
+    thread->heapIndex = i;
+}
+
+void
+ThreadHeap::Swap(int i, int j)
+{
+    Thread *t = items[i];
+    int o = order[i];
+
+    Put(i, items[j], order[j]);
+    Put(j, t, o);
+}
+
+//----------------------------------------------------------------------
+// ThreadHeap::SiftUp, SiftDown
+// 	Restore the heap property after items[i] was changed, by
+//	moving it towards the root or the leaves.
+//----------------------------------------------------------------------
+
+void
+ThreadHeap::SiftUp(int i)
+{
+    int parent;
+
+    while (i > 0) {
+	parent = (i - 1) / 2;
+	if (!Less(i, parent))
+	    break;
+	Swap(i, parent);
+	i = parent;
+    }
+}
+
+void
+ThreadHeap::SiftDown(int i)
+{
+    int child;
+
+    for (;;) {
+	child = 2 * i + 1;
+	if (child >= numInHeap)
+	    break;
+	if (child + 1 < numInHeap && Less(child + 1, child))
+	    child++;
+	if (!Less(child, i))
+	    break;
+	Swap(i, child);
+	i = child;
+    }
+}
+
+//----------------------------------------------------------------------
+// ThreadHeap::Insert
+// 	Put "thread" on the heap, growing it if it is full.
+//----------------------------------------------------------------------
+
+void
+ThreadHeap::Insert(Thread *thread)
+{
+    ASSERT(thread->heapIndex == -1);	// on no heap
+
+    if (numInHeap == size) {
+	Thread **newItems = new Thread *[2 * size];
+	int *newOrder = new int[2 * size];
+
+	for (int i = 0; i < numInHeap; i++) {
+	    newItems[i] = items[i];
+	    newOrder[i] = order[i];
+	}
+	delete [] items;
+	delete [] order;
+	items = newItems;
+	order = newOrder;
+	size *= 2;
+    }
+    Put(numInHeap, thread, nextOrder++);
+    numInHeap++;
+    SiftUp(numInHeap - 1);
+}
+
+//----------------------------------------------------------------------
+// ThreadHeap::RemoveFront
+// 	Take the first thread off the heap, and return it.  Returns
+//	NULL if the heap is empty.
+//----------------------------------------------------------------------
+
+Thread *
+ThreadHeap::RemoveFront()
+{
+    Thread *thread;
+
+    if (numInHeap == 0)
+	return NULL;
+    thread = items[0];
+    thread->heapIndex = -1;
+    numInHeap--;
+    if (numInHeap > 0) {
+	Put(0, items[numInHeap], order[numInHeap]);
+	SiftDown(0);
+    }
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadHeap::Remove
+// 	Take "thread", which must be on the heap, off it.
+//----------------------------------------------------------------------
+
+void
+ThreadHeap::Remove(Thread *thread)
+{
+    int i = thread->heapIndex;
+
+    ASSERT(IsInList(thread));
+    thread->heapIndex = -1;
+    numInHeap--;
+    if (i < numInHeap) {
+	Put(i, items[numInHeap], order[numInHeap]);
+	SiftUp(i);
+	SiftDown(i);
+    }
+}
+
+bool
+ThreadHeap::IsInList(Thread *thread) const
+{
+    int i = thread->heapIndex;
+
+    return i >= 0 && i < numInHeap && items[i] == thread;
+}
+
+void
+ThreadHeap::Apply(void (*func)(Thread *)) const
+{
+    for (int i = 0; i < numInHeap; i++)
+	(*func)(items[i]);
+}
+
+//----------------------------------------------------------------------
+// PriorityBuckets::PriorityBuckets
+// 	Initialize an empty queue for priorities "lowest" to "highest".
+//----------------------------------------------------------------------
+
+PriorityBuckets::PriorityBuckets(int low, int high)
+{
+    lowest = low;
+    highest = high;
+    buckets = new ThreadQueue *[highest - lowest + 1];
+    for (int p = lowest; p <= highest; p++)
+	buckets[p - lowest] = new ThreadQueue;
+    numWords = divRoundUp(highest - lowest + 1, sizeof(unsigned int) * 8);
+    nonEmpty = new unsigned int[numWords];
+    for (int i = 0; i < numWords; i++)
+	nonEmpty[i] = 0;
+    numInList = 0;
+}
+
+//----------------------------------------------------------------------
+// PriorityBuckets::~PriorityBuckets
+// 	De-allocate the buckets.  The threads in them are not touched.
+//----------------------------------------------------------------------
+
+PriorityBuckets::~PriorityBuckets()
+{
+    for (int p = lowest; p <= highest; p++)
+	delete buckets[p - lowest];
+    delete [] buckets;
+    delete [] nonEmpty;
+}
+
+//----------------------------------------------------------------------
+// PriorityBuckets::Mark, Clear, HighestNonEmpty
+// 	Maintain the bitmap of non-empty buckets.  Bit 0 stands for
+//	the highest priority, so the first bit set is the bucket to
+//	take threads from.
+//----------------------------------------------------------------------
+
+void
+PriorityBuckets::Mark(int priority)
+{
+    int bit = highest - priority;
+
+    nonEmpty[bit / (sizeof(unsigned int) * 8)] |=
+			1U << (bit % (sizeof(unsigned int) * 8));
+}
+
+void
+PriorityBuckets::Clear(int priority)
+{
+    int bit = highest - priority;
+
+    nonEmpty[bit / (sizeof(unsigned int) * 8)] &=
+			~(1U << (bit % (sizeof(unsigned int) * 8)));
+}
+
+int
+PriorityBuckets::HighestNonEmpty() const
+{
+    for (int i = 0; i < numWords; i++) {
+	if (nonEmpty[i] != 0)
+	    return highest - (i * sizeof(unsigned int) * 8
+				+ ffs(nonEmpty[i]) - 1);
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// PriorityBuckets::Insert
+// 	Append "thread" to the bucket of its priority.
+//----------------------------------------------------------------------
+
+void
+PriorityBuckets::Insert(Thread *thread)
+{
+    int p = thread->getPriority();
+
+    ASSERT(lowest <= p && p <= highest);
+    buckets[p - lowest]->Append(thread);
+    Mark(p);
+    numInList++;
+}
+
+//----------------------------------------------------------------------
+// PriorityBuckets::RemoveFront
+// 	Take the first thread of the highest priority off the queue,
+//	and return it.  Returns NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+Thread *
+PriorityBuckets::RemoveFront()
+{
+    int p = HighestNonEmpty();
+    Thread *thread;
+
+    if (p < 0)
+	return NULL;
+    thread = buckets[p - lowest]->RemoveFront();
+    if (buckets[p - lowest]->IsEmpty())
+	Clear(p);
+    numInList--;
+    return thread;
+}
+
+Thread *
+PriorityBuckets::Front()
+{
+    int p = HighestNonEmpty();
+
+    if (p < 0)
+	return NULL;
+    return buckets[p - lowest]->Front();
+}
+
+//----------------------------------------------------------------------
+// PriorityBuckets::Remove
+// 	Take "thread" off the queue.  It is looked for in the bucket of
+//	its current priority, so take it off before changing that.
+//----------------------------------------------------------------------
+
+void
+PriorityBuckets::Remove(Thread *thread)
+{
+    int p = thread->getPriority();
+
+    ASSERT(lowest <= p && p <= highest);
+    buckets[p - lowest]->Remove(thread);
+    if (buckets[p - lowest]->IsEmpty())
+	Clear(p);
+    numInList--;
+}
+
+bool
+PriorityBuckets::IsInList(Thread *thread) const
+{
+    int p = thread->getPriority();
+
+    if (p < lowest || p > highest)
+	return FALSE;
+    return buckets[p - lowest]->IsInList(thread);
+}
+
+void
+PriorityBuckets::Apply(void (*func)(Thread *)) const
+{
+    for (int p = highest; p >= lowest; p--)
+	buckets[p - lowest]->Apply(func);
+}
+
+//----------------------------------------------------------------------
+// ThreadTree::ThreadTree
+// 	Initialize an empty tree.
+//----------------------------------------------------------------------
+
+ThreadTree::ThreadTree()
+{
+    nil = new ThreadTreeNode;
+    nil->thread = NULL;
+    nil->red = FALSE;
+    nil->left = nil->right = nil->parent = nil;
+    root = nil;
+    numInTree = 0;
+    nextOrder = 0;
+}
+
+//----------------------------------------------------------------------
+// ThreadTree::~ThreadTree
+// 	De-allocate the tree.  The threads in it are not touched.
+//----------------------------------------------------------------------
+
+ThreadTree::~ThreadTree()
+{
+    while (!IsEmpty())
+	(void) RemoveFront();
+    delete nil;
+}
+
+bool
+ThreadTree::Less(ThreadTreeNode *x, ThreadTreeNode *y) const
+{
+    if (x->key != y->key)
+	return x->key < y->key;
+    return x->order < y->order;
+}
+
+ThreadTreeNode *
+ThreadTree::Minimum(ThreadTreeNode *x) const
+{
+    while (x->left != nil)
+	x = x->left;
+    return x;
+}
+
+//----------------------------------------------------------------------
+// ThreadTree::RotateLeft, RotateRight
+// 	The usual tree rotations around node "x".
+//----------------------------------------------------------------------
+
+void
+ThreadTree::RotateLeft(ThreadTreeNode *x)
+{
+    ThreadTreeNode *y = x->right;
+
+    x->right = y->left;
+    if (y->left != nil)
+	y->left->parent = x;
+    y->parent = x->parent;
+    if (x->parent == nil)
+	root = y;
+    else if (x == x->parent->left)
+	x->parent->left = y;
+    else
+	x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+}
+
+void
+ThreadTree::RotateRight(ThreadTreeNode *x)
+{
+    ThreadTreeNode *y = x->left;
+
+    x->left = y->right;
+    if (y->right != nil)
+	y->right->parent = x;
+    y->parent = x->parent;
+    if (x->parent == nil)
+	root = y;
+    else if (x == x->parent->right)
+	x->parent->right = y;
+    else
+	x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+}
+
+//----------------------------------------------------------------------
+// ThreadTree::Insert
+// 	Put "thread" in the tree under "key", then recolor and rotate
+//	to keep it balanced.
+//----------------------------------------------------------------------
+
+void
+ThreadTree::Insert(Thread *thread, double key)
+{
+    ThreadTreeNode *z = new ThreadTreeNode;
+    ThreadTreeNode *x = root, *y = nil;
+
+    z->thread = thread;
+    z->key = key;
+    z->order = nextOrder++;
+    while (x != nil) {
+	y = x;
+	x = Less(z, x) ? x->left : x->right;
+    }
+    z->parent = y;
+    if (y == nil)
+	root = z;
+    else if (Less(z, y))
+	y->left = z;
+    else
+	y->right = z;
+    z->left = z->right = nil;
+    z->red = TRUE;
+    InsertFixup(z);
+    numInTree++;
+}
+
+void
+ThreadTree::InsertFixup(ThreadTreeNode *z)
+{
+    ThreadTreeNode *y;
+
+    while (z->parent->red) {
+	if (z->parent == z->parent->parent->left) {
+	    y = z->parent->parent->right;
+	    if (y->red) {
+		z->parent->red = FALSE;
+		y->red = FALSE;
+		z->parent->parent->red = TRUE;
+		z = z->parent->parent;
+	    } else {
+		if (z == z->parent->right) {
+		    z = z->parent;
+		    RotateLeft(z);
+		}
+		z->parent->red = FALSE;
+		z->parent->parent->red = TRUE;
+		RotateRight(z->parent->parent);
+	    }
+	} else {
+	    y = z->parent->parent->left;
+	    if (y->red) {
+		z->parent->red = FALSE;
+		y->red = FALSE;
+		z->parent->parent->red = TRUE;
+		z = z->parent->parent;
+	    } else {
+		if (z == z->parent->left) {
+		    z = z->parent;
+		    RotateRight(z);
+		}
+		z->parent->red = FALSE;
+		z->parent->parent->red = TRUE;
+		RotateLeft(z->parent->parent);
+	    }
+	}
+    }
+    root->red = FALSE;
+}
+
+//----------------------------------------------------------------------
+// ThreadTree::RemoveFront
+// 	Take the leftmost node out of the tree, rebalance, and return
+//	its thread.  Returns NULL if the tree is empty.
+//----------------------------------------------------------------------
+
+Thread *
+ThreadTree::RemoveFront()
+{
+    ThreadTreeNode *z, *x;
+    Thread *thread;
+    bool wasRed;
+
+    if (root == nil)
+	return NULL;
+    z = Minimum(root);		// has no left child
+    thread = z->thread;
+    wasRed = z->red;
+    x = z->right;
+    Transplant(z, x);		// sets x->parent, even if x is nil
+    if (!wasRed)
+	DeleteFixup(x);
+    delete z;
+    numInTree--;
+    return thread;
+}
+
+Thread *
+ThreadTree::Front()
+{
+    if (root == nil)
+	return NULL;
+    return Minimum(root)->thread;
+}
+
+void
+ThreadTree::Transplant(ThreadTreeNode *u, ThreadTreeNode *v)
+{
+    if (u->parent == nil)
+	root = v;
+    else if (u == u->parent->left)
+	u->parent->left = v;
+    else
+	u->parent->right = v;
+    v->parent = u->parent;
+}
+
+void
+ThreadTree::DeleteFixup(ThreadTreeNode *x)
+{
+    ThreadTreeNode *w;
+
+    while (x != root && !x->red) {
+	if (x == x->parent->left) {
+	    w = x->parent->right;
+	    if (w->red) {
+		w->red = FALSE;
+		x->parent->red = TRUE;
+		RotateLeft(x->parent);
+		w = x->parent->right;
+	    }
+	    if (!w->left->red && !w->right->red) {
+		w->red = TRUE;
+		x = x->parent;
+	    } else {
+		if (!w->right->red) {
+		    w->left->red = FALSE;
+		    w->red = TRUE;
+		    RotateRight(w);
+		    w = x->parent->right;
+		}
+		w->red = x->parent->red;
+		x->parent->red = FALSE;
+		w->right->red = FALSE;
+		RotateLeft(x->parent);
+		x = root;
+	    }
+	} else {
+	    w = x->parent->left;
+	    if (w->red) {
+		w->red = FALSE;
+		x->parent->red = TRUE;
+		RotateRight(x->parent);
+		w = x->parent->left;
+	    }
+	    if (!w->right->red && !w->left->red) {
+		w->red = TRUE;
+		x = x->parent;
+	    } else {
+		if (!w->left->red) {
+		    w->right->red = FALSE;
+		    w->red = TRUE;
+		    RotateLeft(w);
+		    w = x->parent->left;
+		}
+		w->red = x->parent->red;
+		x->parent->red = FALSE;
+		w->left->red = FALSE;
+		RotateRight(x->parent);
+		x = root;
+	    }
+	}
+    }
+    x->red = FALSE;
+}
+
+void
+ThreadTree::ApplyNode(ThreadTreeNode *x, void (*func)(Thread *)) const
+{
+    if (x == nil)
+	return;
+    ApplyNode(x->left, func);
+    (*func)(x->thread);
+    ApplyNode(x->right, func);
+}
+
+void
+ThreadTree::Apply(void (*func)(Thread *)) const
+{
+    ApplyNode(root, func);
+}
@@ -0,0 +1,153 @@
+// readyqueue.h
+//	Data structures for the ready queues of the multilevel scheduler.
+//
+//	The L1 queue is a binary heap ordered on the estimated CPU burst
+//	(shortest job first), and the L2 queue is an array of FIFO
+//	buckets, one per priority level, with a bitmap of the levels that
+//	are not empty.  Both take O(log n) or O(1) to insert and to remove
+//	the next thread to run, instead of the O(n) insertion of a
+//	SortedList, so the cost of scheduling stays flat when there are
+//	many ready threads.
+//
+//	Both keep threads that compare equal in FIFO order, the way a
+//	SortedList does.
+//
+//	The fair scheduler keeps its threads in a red-black tree ordered
+//	on virtual runtime, so the thread that got least CPU so far is
+//	always found at the leftmost node.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef READYQUEUE_H
+#define READYQUEUE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "thread.h"
+
+// The following class defines a priority queue of threads, kept as a
+// binary min-heap.  "compare" returns -1, 0 or 1 like the compare
+// function of a SortedList.  Each thread keeps its index in the heap
+// (Thread::heapIndex), so finding it to remove it takes O(1); a
+// thread can be on only one heap at a time.
+
+class ThreadHeap {
+  public:
+    ThreadHeap(int (*comp)(Thread *x, Thread *y));
+    ~ThreadHeap();
+
+    void Insert(Thread *thread);	// Put a thread on the heap
+    Thread *RemoveFront();		// Take the smallest thread off
+    Thread *Front() { return items[0]; }
+    void Remove(Thread *thread);	// Take a specific thread off
+    bool IsInList(Thread *thread) const;
+    				// is "thread" on this heap?
+    bool IsEmpty() const { return numInHeap == 0; }
+    int NumInList() const { return numInHeap; }
+    void Apply(void (*func)(Thread *)) const;
+					// Apply "func" to every thread,
+					// in no particular order
+
+  private:
+    int (*compare)(Thread *x, Thread *y);
+    Thread **items;		// the heap, smallest at index 0
+    int *order;			// arrival order of each item, to keep
+				// equal threads FIFO
+    int numInHeap;
+    int size;			// room allocated in "items" and "order"
+    int nextOrder;
+
+    bool Less(int i, int j) const;	// items[i] comes before items[j]?
+    void Swap(int i, int j);
+    void Put(int i, Thread *thread, int arrival);
+    void SiftUp(int i);
+    void SiftDown(int i);
+};
+
+// The following class defines a queue of threads ordered by priority,
+// highest first, and FIFO within a priority.  Each priority level in
+// [lowest, highest] has its own list; a bitmap of non-empty levels
+// finds the highest one with a find-first-set.  The lists are linked
+// through the threads, so nothing is allocated on the way.
+
+class PriorityBuckets {
+  public:
+    PriorityBuckets(int lowest, int highest);
+    ~PriorityBuckets();
+
+    void Insert(Thread *thread);	// Append to its priority's bucket
+    Thread *RemoveFront();		// Take off the first thread of
+					// the highest non-empty bucket
+    Thread *Front();
+    void Remove(Thread *thread);	// Take a specific thread off; it
+					// must not have changed priority
+    bool IsInList(Thread *thread) const;
+    bool IsEmpty() const { return numInList == 0; }
+    int NumInList() const { return numInList; }
+    void Apply(void (*func)(Thread *)) const;
+					// Apply "func" to every thread, in
+					// the order they would be removed
+
+  private:
+    ThreadQueue **buckets;	// one FIFO per priority level
+    unsigned int *nonEmpty;	// bit (highest - p) set if bucket p
+				// is not empty
+    int lowest, highest;
+    int numWords;
+    int numInList;
+
+    int HighestNonEmpty() const;// priority of the first thread, or -1
+    void Mark(int priority);
+    void Clear(int priority);
+};
+
+// The following class defines one node of a ThreadTree.
+
+class ThreadTreeNode {
+  public:
+    Thread *thread;
+    double key;			// the thread's key when inserted
+    int order;			// arrival order, to keep equal keys FIFO
+    bool red;
+    ThreadTreeNode *left, *right, *parent;
+};
+
+// The following class defines a red-black tree of threads, ordered on
+// a key given when the thread is inserted, smallest first.  Insert and
+// RemoveFront take O(log n).
+
+class ThreadTree {
+  public:
+    ThreadTree();
+    ~ThreadTree();
+
+    void Insert(Thread *thread, double key);
+				// Put a thread in the tree
+    Thread *RemoveFront();	// Take the thread with the smallest key
+				// out of the tree; NULL if empty
+    Thread *Front();		// Peek at it
+    bool IsEmpty() const { return numInTree == 0; }
+    int NumInList() const { return numInTree; }
+    void Apply(void (*func)(Thread *)) const;
+				// Apply "func" to every thread, smallest
+				// key first
+
+  private:
+    ThreadTreeNode *root;
+    ThreadTreeNode *nil;	// sentinel, stands for every leaf
+    int numInTree;
+    int nextOrder;
+
+    bool Less(ThreadTreeNode *x, ThreadTreeNode *y) const;
+    ThreadTreeNode *Minimum(ThreadTreeNode *x) const;
+    void RotateLeft(ThreadTreeNode *x);
+    void RotateRight(ThreadTreeNode *x);
+    void InsertFixup(ThreadTreeNode *z);
+    void Transplant(ThreadTreeNode *u, ThreadTreeNode *v);
+    void DeleteFixup(ThreadTreeNode *x);
+    void ApplyNode(ThreadTreeNode *x, void (*func)(Thread *)) const;
+};
+
+#endif // READYQUEUE_H
@@ -0,0 +1,124 @@
+// schedconfig.cc
+//	Routines to set the scheduler parameters from the command line
+//	or from a config file.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "schedconfig.h"
+#include "stats.h"
+#include "sysdep.h"
+#include <iostream>
+
+using namespace std;
+
+// Longest config file we read.
+const int MaxConfigSize = 4096;
+
+//----------------------------------------------------------------------
+// SchedConfig::SchedConfig
+// 	Initialize the parameters to the MP3 values.
+//----------------------------------------------------------------------
+
+SchedConfig::SchedConfig()
+{
+    quantum = TimerTicks;
+    agingTicks = AgingTicks;
+    agingBoost = AgingBoost;
+    maxPriority = MaxPriority;
+    l1Priority = L1Priority;
+    l2Priority = L2Priority;
+}
+
+//----------------------------------------------------------------------
+// SchedConfig::Set
+// 	Set one parameter from "setting", of the form "key=value".
+//	Returns FALSE if the key is unknown.
+//----------------------------------------------------------------------
+
+bool
+SchedConfig::Set(char *setting)
+{
+    char *value = strchr(setting, '=');
+    int keyLength;
+    int n;
+
+    if (value == NULL)
+	return FALSE;
+    keyLength = value - setting;
+    n = atoi(value + 1);
+
+#define KEY(s)	(keyLength == (int) strlen(s) && strncmp(setting, s, keyLength) == 0)
+    if (KEY("quantum"))
+	quantum = n;
+    else if (KEY("aging"))
+	agingTicks = n;
+    else if (KEY("boost"))
+	agingBoost = n;
+    else if (KEY("maxpri"))
+	maxPriority = n;
+    else if (KEY("l1"))
+	l1Priority = n;
+    else if (KEY("l2"))
+	l2Priority = n;
+    else
+	return FALSE;
+#undef KEY
+    DEBUG(dbgThread, "Scheduler parameter " << setting);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SchedConfig::Load
+// 	Apply every "key=value" line of the UNIX file "fileName".  Blank
+//	space is ignored, and "#" starts a comment.
+//----------------------------------------------------------------------
+
+void
+SchedConfig::Load(char *fileName)
+{
+    char *buffer = new char[MaxConfigSize + 1];
+    char *line, *next, *from, *to;
+    int fd, size;
+
+    if ((fd = OpenForReadWrite(fileName, FALSE)) < 0) {
+	cout << "Couldn't open scheduler config " << fileName << "\n";
+	delete [] buffer;
+	return;
+    }
+    size = ReadPartial(fd, buffer, MaxConfigSize);
+    Close(fd);
+    buffer[max(size, 0)] = '\0';
+
+    for (line = buffer; line != NULL; line = next) {
+	next = strchr(line, '\n');
+	if (next != NULL)
+	    *next++ = '\0';
+	for (from = to = line; *from != '\0' && *from != '#'; from++) {
+	    if (*from != ' ' && *from != '\t' && *from != '\r')
+		*to++ = *from;		// squeeze out blanks
+	}
+	*to = '\0';
+	if (*line != '\0' && !Set(line))
+	    cout << fileName << ": unknown scheduler parameter " << line << "\n";
+    }
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// SchedConfig::Check
+// 	The levels must nest: 0 < l2 < l1 <= maxpri, and the times
+//	must be positive.
+//----------------------------------------------------------------------
+
+void
+SchedConfig::Check()
+{
+    ASSERT(quantum > 0);
+    ASSERT(agingTicks > 0 && agingBoost >= 0);
+    ASSERT(0 < l2Priority && l2Priority < l1Priority);
+    ASSERT(l1Priority <= maxPriority);
+}
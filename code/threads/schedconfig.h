@@ -0,0 +1,59 @@
+// schedconfig.h
+//	Data structures for the tunable parameters of the scheduler.
+//
+//	The time slice, the aging rule and the priority ranges of the
+//	MLFQ levels used to be literals.  They are kept here instead,
+//	with the MP3 values as defaults, and can be changed from the
+//	command line ("-sp key=value") or from a file of "key=value"
+//	lines ("-sc file"; "#" starts a comment).  The keys are
+//
+//	    quantum	ticks between timer interrupts (TimerTicks)
+//	    aging	ticks a ready thread waits before it is aged
+//	    boost	how much aging raises its priority
+//	    maxpri	highest priority, aging stops there
+//	    l1		lowest priority of L1 (SJF)
+//	    l2		lowest priority of L2; below it is L3
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDCONFIG_H
+#define SCHEDCONFIG_H
+
+#include "copyright.h"
+
+// MP3 ready threads that waited this long get their priority raised
+const int AgingTicks = 1500;
+const int AgingBoost = 10;
+
+// MP3 priority ranges: L3 is 0-49, L2 50-99, L1 100-149
+const int MaxPriority = 149;
+const int L1Priority = 100;
+const int L2Priority = 50;
+
+// The following class defines the scheduler parameters.
+
+class SchedConfig {
+  public:
+    SchedConfig();		// Start with the defaults
+
+    bool Set(char *setting);	// Apply one "key=value"; FALSE if it
+				// is not a known key
+    void Load(char *fileName);	// Apply every line of a config file
+    void Check();		// Make sure the values make sense
+
+    int Queue(int priority) {	// Which MLFQ level has "priority"?
+	return (priority >= l1Priority) ? 1 :
+			(priority >= l2Priority) ? 2 : 3;
+    }
+
+    int quantum;
+    int agingTicks;
+    int agingBoost;
+    int maxPriority;
+    int l1Priority;
+    int l2Priority;
+};
+
+#endif // SCHEDCONFIG_H
@@ -0,0 +1,307 @@
+// schedmetrics.cc
+//	Routines to account for the time threads spend in each state,
+//	and to report scheduling latency and fairness at halt.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "schedmetrics.h"
+#include "main.h"
+#include "sysdep.h"
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// ThreadUsage::ThreadUsage
+// 	Initialize the record of a thread that was just created.
+//----------------------------------------------------------------------
+
+ThreadUsage::ThreadUsage(char *threadName, int threadID)
+{
+    name = threadName;
+    id = threadID;
+    status = JUST_CREATED;
+    lastChange = kernel->stats->totalTicks;
+    exited = FALSE;
+    readyTicks = runTicks = blockedTicks = 0;
+    dispatches = preemptions = promotions = 0;
+    maxLatency = 0;
+    totalLatency = 0;
+}
+
+//----------------------------------------------------------------------
+// ThreadUsage::Charge
+// 	Add the ticks since the last status change to the time spent
+//	in the current status.
+//----------------------------------------------------------------------
+
+void
+ThreadUsage::Charge(int now)
+{
+    switch (status) {
+      case READY:
+	readyTicks += now - lastChange;
+	break;
+      case RUNNING:
+	runTicks += now - lastChange;
+	break;
+      case BLOCKED:
+	blockedTicks += now - lastChange;
+	break;
+      default:
+	break;
+    }
+    lastChange = now;
+}
+
+double
+ThreadUsage::Share()
+{
+    if (runTicks + readyTicks == 0)
+	return 0.0;
+    return (double) runTicks / (runTicks + readyTicks);
+}
+
+//----------------------------------------------------------------------
+// ThreadUsage::WriteCSV
+// 	Write the time in each state, and the mean and worst scheduling
+//	latency, of one thread as a line of the CSV file "fd".  The name
+//	is written as it is, so that it may be of any length.
+//----------------------------------------------------------------------
+
+void
+ThreadUsage::WriteCSV(int fd)
+{
+    char line[160];		// room for ten numbers
+
+    snprintf(line, sizeof(line), "%d,", id);
+    WriteFile(fd, line, strlen(line));
+    WriteFile(fd, name, strlen(name));
+    snprintf(line, sizeof(line), ",%d,%d,%d,%d,%d,%d,%.2f,%d\n",
+		readyTicks, runTicks, blockedTicks, dispatches,
+		preemptions, promotions,
+		dispatches > 0 ? totalLatency / dispatches : 0.0, maxLatency);
+    WriteFile(fd, line, strlen(line));
+}
+
+//----------------------------------------------------------------------
+// SchedMetrics::SchedMetrics
+// 	Initialize, with no threads and no samples yet, and start the
+//	CSV file, if there is to be one.
+//
+//	"csvFileName" is where to write the per-thread numbers, or NULL
+//----------------------------------------------------------------------
+
+SchedMetrics::SchedMetrics(char *csvFileName)
+{
+    char *header = "id,name,ready,running,blocked,dispatches,preemptions,"
+		"promotions,mean_latency,max_latency\n";
+
+    usages = new UsageList;
+    for (int i = 0; i < LatencyBuckets; i++)
+	latencies[i] = 0;
+    numLatencies = maxLatency = 0;
+    exitedThreads = shareCount = 0;
+    shareSum = shareSquares = 0;
+
+    csvFd = -1;
+    if (csvFileName != NULL) {
+	if ((csvFd = OpenForWrite(csvFileName)) < 0)
+	    cout << "Couldn't write scheduler metrics to " << csvFileName
+		<< "\n";
+	else
+	    WriteFile(csvFd, header, strlen(header));
+    }
+}
+
+SchedMetrics::~SchedMetrics()
+{
+    while (!usages->IsEmpty())
+	delete usages->RemoveFront();
+    delete usages;
+    if (csvFd >= 0)
+	Close(csvFd);
+}
+
+void
+SchedMetrics::Register(ThreadUsage *usage)
+{
+    usages->Append(usage);
+}
+
+//----------------------------------------------------------------------
+// SchedMetrics::StatusChanged
+// 	Charge "thread" for the time in its old status.  Going from
+//	ready to running is a dispatch, and gives a latency sample;
+//	going from running back to ready is a preemption.
+//
+//	"status" is the status "thread" is about to get
+//----------------------------------------------------------------------
+
+void
+SchedMetrics::StatusChanged(Thread *thread, ThreadStatus status)
+{
+    ThreadUsage *usage = thread->usage;
+    int now = kernel->stats->totalTicks;
+    int latency;
+
+    if (usage == NULL || usage->exited)
+	return;
+    if (usage->status == READY && status == RUNNING) {
+	latency = now - usage->lastChange;
+	usage->dispatches++;
+	usage->totalLatency += latency;
+	usage->maxLatency = max(usage->maxLatency, latency);
+	latencies[min(latency, LatencyBuckets - 1)]++;
+	numLatencies++;
+	maxLatency = max(maxLatency, latency);
+    } else if (usage->status == RUNNING && status == READY)
+	usage->preemptions++;
+
+    usage->Charge(now);
+    usage->status = status;
+}
+
+void
+SchedMetrics::Promoted(Thread *thread)
+{
+    if (thread->usage != NULL)
+	thread->usage->promotions++;
+}
+
+//----------------------------------------------------------------------
+// SchedMetrics::AddShare
+// 	Add the share of its ready time "usage" ran to the totals.
+//	Threads that never wanted the CPU are left out.
+//----------------------------------------------------------------------
+
+void
+SchedMetrics::AddShare(ThreadUsage *usage)
+{
+    double x = usage->Share();
+
+    if (usage->runTicks + usage->readyTicks == 0)
+	return;
+    shareSum += x;
+    shareSquares += x * x;
+    shareCount++;
+}
+
+//----------------------------------------------------------------------
+// SchedMetrics::Exited
+// 	"thread" is finishing; stop accounting for it.  Its numbers go
+//	to the CSV file and into the totals, and its record is freed.
+//----------------------------------------------------------------------
+
+void
+SchedMetrics::Exited(Thread *thread)
+{
+    ThreadUsage *usage = thread->usage;
+
+    if (usage == NULL)
+	return;
+    StatusChanged(thread, ZOMBIE);
+    usage->exited = TRUE;
+    if (csvFd >= 0)
+	usage->WriteCSV(csvFd);
+    AddShare(usage);
+    exitedThreads++;
+    usages->Remove(usage);
+    delete usage;
+    thread->usage = NULL;
+}
+
+//----------------------------------------------------------------------
+// SchedMetrics::Percentile
+// 	Return the "p"th percentile of the latency samples, by nearest
+//	rank.  Latencies of LatencyBuckets - 1 ticks or more all count
+//	as that.
+//----------------------------------------------------------------------
+
+int
+SchedMetrics::Percentile(int p)
+{
+    int rank, latency;
+
+    // p * numLatencies / 100, rounded up, without overflowing
+    rank = (numLatencies / 100) * p
+		+ divRoundUp((numLatencies % 100) * p, 100);
+    rank = max(rank, 1);
+
+    for (latency = 0; latency < LatencyBuckets - 1; latency++) {
+	rank -= latencies[latency];
+	if (rank <= 0)
+	    break;
+    }
+    return latency;
+}
+
+//----------------------------------------------------------------------
+// SchedMetrics::FairnessIndex
+// 	Jain's fairness index, (sum x)^2 / (n * sum x^2), where x is the
+//	share of its ready time a thread ran.  1 is perfectly fair, 1/n
+//	is one thread getting everything.  Threads that never wanted
+//	the CPU are left out.  Exited threads are in the totals; live
+//	ones are added here.
+//----------------------------------------------------------------------
+
+double
+SchedMetrics::FairnessIndex()
+{
+    UsageIterator iter(usages);
+    double sum = shareSum, sumSquares = shareSquares, x;
+    int n = shareCount;
+
+    for (; !iter.IsDone(); iter.Next()) {
+	if (iter.Item()->runTicks + iter.Item()->readyTicks == 0)
+	    continue;
+	x = iter.Item()->Share();
+	sum += x;
+	sumSquares += x * x;
+	n++;
+    }
+    if (n == 0 || sumSquares == 0)
+	return 1.0;
+    return (sum * sum) / (n * sumSquares);
+}
+
+//----------------------------------------------------------------------
+// SchedMetrics::Print
+// 	Print the latency percentiles and the fairness index, at halt.
+//	Threads still alive are charged up to now, and written to the
+//	CSV file, if any, which is then closed.
+//----------------------------------------------------------------------
+
+void
+SchedMetrics::Print()
+{
+    UsageIterator iter(usages);
+
+    for (; !iter.IsDone(); iter.Next()) {
+	iter.Item()->Charge(kernel->stats->totalTicks);
+	if (csvFd >= 0)
+	    iter.Item()->WriteCSV(csvFd);
+    }
+
+    if (csvFd >= 0) {
+	Close(csvFd);
+	csvFd = -1;
+    }
+
+    cout << "Scheduling: dispatches " << numLatencies;
+    if (numLatencies > 0) {
+	cout << ", latency p50 " << Percentile(50);
+	cout << ", p95 " << Percentile(95);
+	cout << ", p99 " << Percentile(99);
+	cout << ", max " << maxLatency;
+    }
+    cout << ", fairness " << FairnessIndex();
+    cout << ", threads " << usages->NumInList() + exitedThreads;
+    cout << " (" << exitedThreads << " exited)\n";
+}
@@ -0,0 +1,105 @@
+// schedmetrics.h
+//	Data structures to measure how well the scheduler does.
+//
+//	Every thread keeps a ThreadUsage record of the ticks it spent
+//	ready, running and blocked, how often it was dispatched and
+//	preempted, and how often aging raised its priority.  The time
+//	from becoming ready to being dispatched (the scheduling latency)
+//	of every dispatch goes into a histogram.
+//
+//	At halt, the 50th, 95th and 99th percentile of the scheduling
+//	latency are printed, and Jain's fairness index over the share
+//	of its ready time each thread actually got to run.  When a
+//	thread exits, its record is folded into the totals and freed,
+//	so that forking many threads does not use up memory.  The
+//	per-thread numbers go to a CSV file, with -sm: one line as each
+//	thread exits, and one for each thread still there at halt.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDMETRICS_H
+#define SCHEDMETRICS_H
+
+#include "copyright.h"
+#include "ilist.h"
+#include "thread.h"
+
+// The following class records the scheduling history of one thread.
+
+class ThreadUsage {
+  public:
+    ThreadUsage(char *threadName, int threadID);
+
+    char *name;
+    int id;
+    ListLink<ThreadUsage> link;	// on the list of live threads
+    ThreadStatus status;	// status as of "lastChange"
+    int lastChange;		// tick of the last status change
+    bool exited;		// TRUE once the thread has finished
+
+    int readyTicks;		// ticks spent on a ready queue
+    int runTicks;		// ticks spent running
+    int blockedTicks;		// ticks spent waiting for something
+    int dispatches;		// times it was given the CPU
+    int preemptions;		// times it went back to the ready queue
+    int promotions;		// times aging raised its priority
+    int maxLatency;		// longest wait on the ready queue
+    double totalLatency;
+
+    void Charge(int now);	// Account for the ticks up to "now"
+    double Share();		// run / (run + ready) ticks
+    void WriteCSV(int fd);	// write one line of the CSV file
+};
+
+// Latencies up to this many ticks are kept exactly; longer ones all
+// count as this long (the maximum is kept apart).
+const int LatencyBuckets = 1024;
+
+typedef IntrusiveList<ThreadUsage, &ThreadUsage::link> UsageList;
+typedef IntrusiveListIterator<ThreadUsage, &ThreadUsage::link> UsageIterator;
+
+// The following class collects the ThreadUsage of every live thread,
+// the totals of the threads that exited, and the scheduling latency
+// of every dispatch.
+
+class SchedMetrics {
+  public:
+    SchedMetrics(char *csvFileName);
+				// "csvFileName" is where to write the
+				// report as CSV, NULL for nowhere
+    ~SchedMetrics();
+
+    void Register(ThreadUsage *usage);
+				// Remember a new thread
+    void StatusChanged(Thread *thread, ThreadStatus status);
+				// "thread" is about to change status
+    void Promoted(Thread *thread);
+				// Aging raised "thread"'s priority
+    void Exited(Thread *thread);
+				// "thread" is finishing; fold it into
+				// the totals
+
+    void Print();		// Print the report, at halt
+
+  private:
+    UsageList *usages;		// every thread still alive
+    int csvFd;			// CSV file, -1 if none
+
+    int latencies[LatencyBuckets];
+				// how many dispatches had each latency
+    int numLatencies;
+    int maxLatency;		// longest latency of all
+
+    int exitedThreads;		// threads folded into the totals:
+    int shareCount;		// how many of them wanted the CPU,
+    double shareSum;		// and the sum of their shares and
+    double shareSquares;	// of their squares
+
+    void AddShare(ThreadUsage *usage);
+    int Percentile(int p);
+    double FairnessIndex();
+};
+
+#endif // SCHEDMETRICS_H
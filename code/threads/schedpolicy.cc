@@ -0,0 +1,520 @@
+// schedpolicy.cc
+//	Routines of the scheduling policies: which ready thread to run
+//	next, and when to take the CPU away from the current thread.
+//
+// 	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "schedpolicy.h"
+#include "main.h"
+#include <iostream>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// NewSchedulingPolicy
+// 	Return a new policy of the kind called "name", or NULL if
+//	there is no such policy.
+//
+//	"config" has the parameters of the MLFQ policy
+//----------------------------------------------------------------------
+
+SchedulingPolicy *
+NewSchedulingPolicy(char *name, SchedConfig *config)
+{
+    if (strcmp(name, "mlfq") == 0)
+	return new MLFQPolicy(config);
+    if (strcmp(name, "rr") == 0)
+	return new RRPolicy();
+    if (strcmp(name, "cfs") == 0)
+	return new CFSPolicy();
+    if (strcmp(name, "lottery") == 0)
+	return new LotteryPolicy();
+    if (strcmp(name, "stride") == 0)
+	return new StridePolicy();
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// RanTicks
+// 	Return how long the current thread "thread" has been running
+//	since it was last dispatched, at least one tick so that a
+//	thread which keeps blocking at once is still charged.
+//----------------------------------------------------------------------
+
+static int
+RanTicks(Thread *thread)
+{
+    return max(kernel->stats->userTicks - thread->getStartTime(), 1);
+}
+
+/* MP3 Compare func */
+static int
+burstCmp(Thread *a, Thread *b)
+{
+    int aTime = a->getBurstTime();
+    int bTime = b->getBurstTime();
+    if(aTime == bTime)  return 0;
+    else if(aTime > bTime) return 1;
+    else return -1;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::MLFQPolicy
+// 	Initialize the three ready queues.
+//
+//	"schedConfig" has the priority ranges and the aging rule
+//----------------------------------------------------------------------
+
+MLFQPolicy::MLFQPolicy(SchedConfig *schedConfig)
+{
+    config = schedConfig;
+    readyList = new ThreadQueue;
+
+    /* MP3 Init Queue */
+    L1Queue = new ThreadHeap(burstCmp);
+    L2Queue = new PriorityBuckets(config->l2Priority, config->l1Priority - 1);
+    agingList = new IntrusiveList<Thread, &Thread::agingLink>;
+}
+
+MLFQPolicy::~MLFQPolicy()
+{
+    delete readyList;
+    delete L1Queue;
+    delete L2Queue;
+    delete agingList;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Enqueue
+// 	Put "thread" on the queue of its priority.  Its wait has just
+//	started, so it also goes to the end of agingList.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Enqueue(Thread *thread)
+{
+    /* MP3 into queue */
+    int queue = config->Queue(thread->getPriority());
+    if(queue == 1)
+        L1Queue->Insert(thread);
+    else if(queue == 2)
+        L2Queue->Insert(thread);
+    else
+        readyList->Append(thread);
+    kernel->schedTrace->Record(TraceInserted, thread->getID(), queue);
+
+    /* MP3 Aging , now thread starts to wait */
+    agingList->Append(thread);
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Dequeue
+// 	Take the first thread off the highest non-empty queue.
+//----------------------------------------------------------------------
+
+Thread *
+MLFQPolicy::Dequeue()
+{
+    /* MP3 Which is Next ? */
+    Thread *thread;
+    int queue;
+    if(!L1Queue->IsEmpty())
+    {
+        thread = L1Queue->RemoveFront();
+        queue = 1;
+    }
+    else if(!L2Queue->IsEmpty())
+    {
+        thread = L2Queue->RemoveFront();
+        queue = 2;
+    }
+    else if (!readyList->IsEmpty())
+    {
+        thread = readyList->RemoveFront();
+        queue = 3;
+    }
+    else
+        return NULL;
+    kernel->schedTrace->Record(TraceRemoved, thread->getID(), queue);
+
+    agingList->Remove(thread);		/* no longer waiting */
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Stopped
+// 	Update the SJF burst estimate of an L1 thread: half the burst
+//	it just ran, half the old estimate.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Stopped(Thread *thread)
+{
+	/* SJF  */
+	if(config->Queue(thread->getPriority()) == 1)
+	{
+		double actBurst = kernel->stats->userTicks - thread->getStartTime();
+		double estBurst = 0.5 * actBurst + 0.5 * thread->getBurstTime();
+		thread->setBurstTime(estBurst);
+	}
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::ShouldPreempt
+// 	Only SJF is preemptive: an L1 thread that is expected to finish
+//	its burst before the current L1 thread takes over the CPU.
+//----------------------------------------------------------------------
+
+bool
+MLFQPolicy::ShouldPreempt(Thread *thread)
+{
+    Thread *current = kernel->currentThread;
+
+    if (config->Queue(thread->getPriority()) != 1
+    		|| config->Queue(current->getPriority()) != 1)
+        return FALSE;
+    if (current->getID() == thread->getID())
+        return FALSE;
+
+    double actBurst = kernel->stats->userTicks - current->getStartTime();
+    double estBurst = 0.5 * actBurst + 0.5 * current->getBurstTime();
+    return thread->getBurstTime() < estBurst;
+}
+
+/* MP3 Check aging */
+bool
+MLFQPolicy::CheckAging(Thread *thread)
+{
+    int nowTime = kernel->stats->totalTicks;
+    /* In ready queue and wait time >= config->agingTicks */
+    if(thread->getStatus() == READY && nowTime - thread->getStartWaitTime() >= config->agingTicks)
+    {
+        /* Aging */
+        int oldPriority = thread->getPriority();
+        int newPriority = min(oldPriority + config->agingBoost, config->maxPriority);
+        int from = config->Queue(oldPriority);
+        int to = config->Queue(newPriority);
+        thread->setPriority(newPriority);
+        if(oldPriority != newPriority){
+          kernel->schedTrace->Record(TracePriority, thread->getID(),
+          				oldPriority, newPriority);
+          kernel->schedMetrics->Promoted(thread);
+        }
+
+        if(from != 1 && to == 1) /* L2 (or L3) -> L1 */
+        {
+            if(from == 3)
+                readyList->Remove(thread);
+            else if(L2Queue->IsInList(thread))
+                L2Queue->Remove(thread);
+            L1Queue->Insert(thread);
+            kernel->schedTrace->Record(TraceRemoved, thread->getID(), from);
+            kernel->schedTrace->Record(TraceInserted, thread->getID(), 1);
+
+            /* Reset wait time, before we may yield */
+            thread->setStartWaitTime(nowTime);
+
+            /* Preemptive , Only SJF */
+            if (ShouldPreempt(thread))
+                kernel->currentThread->Yield();
+            return TRUE;
+        }
+        else if(from == 3 && to == 2) /* L3 -> L2 */
+        {
+            readyList->Remove(thread);
+            L2Queue->Insert(thread);
+            kernel->schedTrace->Record(TraceRemoved, thread->getID(), 3);
+            kernel->schedTrace->Record(TraceInserted, thread->getID(), 2);
+        }
+        /* Reset wait time */
+        thread->setStartWaitTime(nowTime);
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Tick
+// 	Called on every tick: give every ready thread that has waited
+//	config->agingTicks its priority boost.
+//
+//	Ready threads are also kept on agingList, in the order their
+//	wait started.  A thread's wait only starts over when it becomes
+//	ready or is aged, and then it goes to the end of agingList, so
+//	the list stays sorted on startWaitTime.  Only its front can be
+//	due, and a tick when nobody is due costs one comparison.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Tick()
+{
+    Thread *t;
+    int p;
+
+    while (!agingList->IsEmpty()) {
+        t = agingList->Front();
+        if (kernel->stats->totalTicks - t->getStartWaitTime() < config->agingTicks)
+            break;			/* nobody behind it is due either */
+        agingList->RemoveFront();
+        agingList->Append(t);		/* its wait starts over */
+
+        p = t->getPriority();
+        if (config->Queue(p) == 2) {	/* take it out while the bucket */
+            L2Queue->Remove(t);		/* is still known */
+            if (!CheckAging(t))
+                L2Queue->Insert(t);
+        } else
+            CheckAging(t);
+    }
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Reprioritize
+// 	Move the ready thread "thread" to the queue of its new priority.
+//	Its place on agingList does not change: it is still waiting.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Reprioritize(Thread *thread, int priority)
+{
+    int from = config->Queue(thread->getPriority());
+    int to = config->Queue(priority);
+
+    if (from == 1)			/* take it out while its place */
+        L1Queue->Remove(thread);	/* is still known */
+    else if (from == 2)
+        L2Queue->Remove(thread);
+    else
+        readyList->Remove(thread);
+    thread->setPriority(priority);
+    if (to == 1)
+        L1Queue->Insert(thread);
+    else if (to == 2)
+        L2Queue->Insert(thread);
+    else
+        readyList->Append(thread);
+    if (from != to) {
+        kernel->schedTrace->Record(TraceRemoved, thread->getID(), from);
+        kernel->schedTrace->Record(TraceInserted, thread->getID(), to);
+    }
+}
+
+void
+MLFQPolicy::Print()
+{
+    L1Queue->Apply(ThreadPrint);
+    L2Queue->Apply(ThreadPrint);
+    readyList->Apply(ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// RRPolicy::Dequeue
+// 	Take the thread that waited longest off the ready list.
+//----------------------------------------------------------------------
+
+Thread *
+RRPolicy::Dequeue()
+{
+    if (readyList->IsEmpty())
+	return NULL;
+    return readyList->RemoveFront();
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::CFSPolicy
+// 	Initialize an empty tree.
+//----------------------------------------------------------------------
+
+CFSPolicy::CFSPolicy()
+{
+    tree = new ThreadTree;
+    minVirtualTime = 0;
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::Enqueue
+// 	Put "thread" in the tree.  A thread that slept for a long time
+//	(or is new) is moved up to the smallest virtual runtime, so it
+//	cannot make up for all the time it did not want the CPU.
+//----------------------------------------------------------------------
+
+void
+CFSPolicy::Enqueue(Thread *thread)
+{
+    if (thread->getVirtualTime() < minVirtualTime)
+	thread->setVirtualTime(minVirtualTime);
+    tree->Insert(thread, thread->getVirtualTime());
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::Dequeue
+// 	Take the thread with the smallest virtual runtime out of the
+//	tree.
+//----------------------------------------------------------------------
+
+Thread *
+CFSPolicy::Dequeue()
+{
+    Thread *thread = tree->RemoveFront();
+
+    if (thread != NULL && thread->getVirtualTime() > minVirtualTime)
+	minVirtualTime = thread->getVirtualTime();
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::Stopped
+// 	Charge "thread" for the ticks it ran, less for a higher
+//	priority.
+//----------------------------------------------------------------------
+
+void
+CFSPolicy::Stopped(Thread *thread)
+{
+    double weight = (double) CFSWeightScale
+			/ (thread->getPriority() + CFSWeightScale);
+
+    thread->setVirtualTime(thread->getVirtualTime()
+				+ RanTicks(thread) * weight);
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::ShouldPreempt
+// 	A thread that wakes up runs at once if the current thread,
+//	counting the ticks of its current burst, is well ahead of it.
+//----------------------------------------------------------------------
+
+bool
+CFSPolicy::ShouldPreempt(Thread *thread)
+{
+    Thread *current = kernel->currentThread;
+    double weight = (double) CFSWeightScale
+			/ (current->getPriority() + CFSWeightScale);
+    double running = current->getVirtualTime()
+		+ (kernel->stats->userTicks - current->getStartTime()) * weight;
+
+    if (current == thread || current->getStatus() != RUNNING)
+	return FALSE;
+    return thread->getVirtualTime() + CFSGranularity < running;
+}
+
+//----------------------------------------------------------------------
+// LotteryPolicy::LotteryPolicy
+// 	Initialize an empty ready list.
+//----------------------------------------------------------------------
+
+LotteryPolicy::LotteryPolicy()
+{
+    readyList = new ThreadQueue;
+    totalTickets = 0;
+}
+
+void
+LotteryPolicy::Enqueue(Thread *thread)
+{
+    readyList->Append(thread);
+    totalTickets += thread->getPriority() + 1;
+}
+
+//----------------------------------------------------------------------
+// LotteryPolicy::Dequeue
+// 	Draw a ticket, and take the thread holding it off the ready
+//	list.  A thread holds priority + 1 tickets.
+//----------------------------------------------------------------------
+
+Thread *
+LotteryPolicy::Dequeue()
+{
+    ThreadQueueIterator iter(readyList);
+    Thread *thread = NULL;
+    int ticket;
+
+    if (readyList->IsEmpty())
+	return NULL;
+    ticket = RandomNumber() % totalTickets;
+    for (; !iter.IsDone(); iter.Next()) {
+	thread = iter.Item();
+	ticket -= thread->getPriority() + 1;
+	if (ticket < 0)
+	    break;
+    }
+    readyList->Remove(thread);
+    totalTickets -= thread->getPriority() + 1;
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// LotteryPolicy::Reprioritize
+// 	A new priority means a new number of tickets.
+//----------------------------------------------------------------------
+
+void
+LotteryPolicy::Reprioritize(Thread *thread, int priority)
+{
+    totalTickets += priority - thread->getPriority();
+    thread->setPriority(priority);
+}
+
+/* order threads on their pass */
+static int
+passCmp(Thread *a, Thread *b)
+{
+    if (a->getVirtualTime() == b->getVirtualTime())
+	return 0;
+    return (a->getVirtualTime() > b->getVirtualTime()) ? 1 : -1;
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::StridePolicy
+// 	Initialize an empty heap.
+//----------------------------------------------------------------------
+
+StridePolicy::StridePolicy()
+{
+    heap = new ThreadHeap(passCmp);
+    minPass = 0;
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::Enqueue
+// 	Put "thread" on the heap.  Like for CFS, a thread that was away
+//	starts from the current pass, not from where it left off.
+//----------------------------------------------------------------------
+
+void
+StridePolicy::Enqueue(Thread *thread)
+{
+    if (thread->getVirtualTime() < minPass)
+	thread->setVirtualTime(minPass);
+    heap->Insert(thread);
+}
+
+Thread *
+StridePolicy::Dequeue()
+{
+    Thread *thread = heap->RemoveFront();
+
+    if (thread != NULL)
+	minPass = thread->getVirtualTime();
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::Stopped
+// 	Advance the pass of "thread" by its stride for every tick it
+//	ran.
+//----------------------------------------------------------------------
+
+void
+StridePolicy::Stopped(Thread *thread)
+{
+    double stride = (double) StrideScale / (thread->getPriority() + 1);
+
+    thread->setVirtualTime(thread->getVirtualTime()
+				+ RanTicks(thread) * stride);
+}
@@ -0,0 +1,197 @@
+// schedpolicy.h
+//	Data structures for the scheduling policies.
+//
+//	The scheduler only knows how to dispatch threads; which ready
+//	thread runs next is up to a SchedulingPolicy.  Each policy keeps
+//	its own ready queue, and is told when a thread becomes ready,
+//	when it stops running, and when the clock ticks.
+//
+//	The policies are:
+//
+//	    mlfq    the MP3 multilevel feedback queue: L1 is preemptive
+//		    SJF (priority 100-149), L2 is by priority (50-99),
+//		    L3 is round robin (0-49), with aging.  The default.
+//		    The ranges and aging can be changed; see schedconfig.h
+//	    rr	    plain round robin, every thread time-sliced
+//	    cfs	    completely fair: run the thread with the least
+//		    virtual runtime, weighted by priority
+//	    lottery draw a ticket, priority + 1 tickets per thread
+//	    stride  deterministic lottery: run the thread with the
+//		    smallest pass, which advances by a stride inversely
+//		    proportional to its tickets
+//
+//	The policy is chosen with the -sched flag.
+//
+// 	All these routines assume that interrupts are already disabled,
+//	like the rest of the scheduler.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDPOLICY_H
+#define SCHEDPOLICY_H
+
+#include "copyright.h"
+#include "list.h"
+#include "thread.h"
+#include "readyqueue.h"
+#include "schedconfig.h"
+
+// A CFS thread of priority p is charged CFSWeightScale / (p +
+// CFSWeightScale) of virtual runtime for every tick it runs.
+const int CFSWeightScale = 10;
+
+// A CFS thread waking up is preempting the running thread only if it
+// is behind by more than this much virtual runtime, so that threads
+// with nearly the same runtime do not keep switching.
+const int CFSGranularity = 10;
+
+// The stride of a thread is StrideScale / tickets.
+const int StrideScale = 10000;
+
+// The following class defines the interface between the scheduler and
+// a scheduling policy.
+
+class SchedulingPolicy {
+  public:
+    virtual ~SchedulingPolicy() {}
+
+    virtual char *Name() = 0;
+
+    virtual void Enqueue(Thread *thread) = 0;
+    				// "thread" is ready to run
+    virtual Thread *Dequeue() = 0;
+    				// Take the next thread to run off the
+				// ready queue; NULL if none
+    virtual bool IsEmpty() = 0;	// Is no thread ready?
+    virtual void Stopped(Thread *thread) {}
+    				// "thread", the current thread, stops
+				// running; charge it for its burst
+    virtual bool ShouldPreempt(Thread *thread) { return FALSE; }
+    				// Should the current thread yield to
+				// "thread", which just became ready?
+    virtual bool Preemptible(Thread *thread) { return TRUE; }
+    				// May the timer slice "thread"?
+    virtual void Tick() {}	// Called on every clock tick
+    virtual void Reprioritize(Thread *thread, int priority) {
+	thread->setPriority(priority);
+    }				// Ready "thread" gets a new priority;
+				// move it where that belongs
+    virtual void Print() = 0;	// Print the ready queue
+};
+
+// Return the policy called "name", or NULL if there is none.
+extern SchedulingPolicy *NewSchedulingPolicy(char *name,
+						SchedConfig *config);
+
+// The following class defines the MP3 multilevel feedback queue.
+
+class MLFQPolicy : public SchedulingPolicy {
+  public:
+    MLFQPolicy(SchedConfig *schedConfig);
+    ~MLFQPolicy();
+
+    char *Name() { return "mlfq"; }
+    void Enqueue(Thread *thread);
+    Thread *Dequeue();
+    bool IsEmpty() { return agingList->IsEmpty(); }
+    void Stopped(Thread *thread);
+    bool ShouldPreempt(Thread *thread);
+    bool Preemptible(Thread *thread) {
+	return config->Queue(thread->getPriority()) == 3;
+    }
+    void Tick();		// Age the ready threads that waited
+				// config->agingTicks
+    void Reprioritize(Thread *thread, int priority);
+    void Print();
+
+  private:
+    bool CheckAging(Thread *thread);
+
+    SchedConfig *config;
+    ThreadQueue *readyList;	// L3, round robin, priority 0-49
+    ThreadHeap *L1Queue;	// SJF on burstTime, priority 100-149
+    PriorityBuckets *L2Queue;	// by priority, 50-99 (by default)
+    IntrusiveList<Thread, &Thread::agingLink> *agingList;
+				// every ready thread, oldest wait first
+};
+
+// The following class defines a round robin policy.
+
+class RRPolicy : public SchedulingPolicy {
+  public:
+    RRPolicy() { readyList = new ThreadQueue; }
+    ~RRPolicy() { delete readyList; }
+
+    char *Name() { return "rr"; }
+    void Enqueue(Thread *thread) { readyList->Append(thread); }
+    Thread *Dequeue();
+    bool IsEmpty() { return readyList->IsEmpty(); }
+    void Print() { readyList->Apply(ThreadPrint); }
+
+  private:
+    ThreadQueue *readyList;
+};
+
+// The following class defines a completely fair policy.  Threads are
+// kept in a red-black tree on their virtual runtime.
+
+class CFSPolicy : public SchedulingPolicy {
+  public:
+    CFSPolicy();
+    ~CFSPolicy() { delete tree; }
+
+    char *Name() { return "cfs"; }
+    void Enqueue(Thread *thread);
+    Thread *Dequeue();
+    bool IsEmpty() { return tree->IsEmpty(); }
+    void Stopped(Thread *thread);
+    bool ShouldPreempt(Thread *thread);
+    void Print() { tree->Apply(ThreadPrint); }
+
+  private:
+    ThreadTree *tree;
+    double minVirtualTime;	// no ready thread is further behind
+};
+
+// The following class defines a lottery policy.
+
+class LotteryPolicy : public SchedulingPolicy {
+  public:
+    LotteryPolicy();
+    ~LotteryPolicy() { delete readyList; }
+
+    char *Name() { return "lottery"; }
+    void Enqueue(Thread *thread);
+    Thread *Dequeue();
+    bool IsEmpty() { return readyList->IsEmpty(); }
+    void Reprioritize(Thread *thread, int priority);
+    void Print() { readyList->Apply(ThreadPrint); }
+
+  private:
+    ThreadQueue *readyList;
+    int totalTickets;		// tickets held by the ready threads
+};
+
+// The following class defines a stride scheduling policy.  A thread's
+// pass is kept in its virtual runtime.
+
+class StridePolicy : public SchedulingPolicy {
+  public:
+    StridePolicy();
+    ~StridePolicy() { delete heap; }
+
+    char *Name() { return "stride"; }
+    void Enqueue(Thread *thread);
+    Thread *Dequeue();
+    bool IsEmpty() { return heap->IsEmpty(); }
+    void Stopped(Thread *thread);
+    void Print() { heap->Apply(ThreadPrint); }
+
+  private:
+    ThreadHeap *heap;		// ordered on pass
+    double minPass;		// pass of the last thread dispatched
+};
+
+#endif // SCHEDPOLICY_H
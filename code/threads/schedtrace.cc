@@ -0,0 +1,166 @@
+// schedtrace.cc
+//	Routines to record scheduler events, and to print a binary
+//	trace of them as text.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "schedtrace.h"
+#include "main.h"
+#include "sysdep.h"
+#include <iostream>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// TraceEvent::Print
+// 	Print one event, the way the scheduler used to print it as it
+//	happened.
+//----------------------------------------------------------------------
+
+void
+TraceEvent::Print()
+{
+    cout << "Tick " << tick << ": Thread " << thread;
+    switch (type) {
+      case TraceInserted:
+	cout << " is inserted into queue L" << arg1 << endl;
+	break;
+      case TraceRemoved:
+	cout << " is removed from queue L" << arg1 << endl;
+	break;
+      case TracePriority:
+	cout << " changes its priority from " << arg1 << " to " << arg2 << endl;
+	break;
+      case TraceSelected:
+	cout << " is now selected for execution" << endl;
+	break;
+      case TraceReplaced:
+	cout << " is replaced, and it has executed " << arg1 << " ticks" << endl;
+	break;
+      default:
+	cout << " did unknown event " << type << endl;
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::SchedTrace
+// 	Set up the trace.
+//
+//	"fileName" is the UNIX file to write a binary trace to, or "off"
+//	or "text" (also if NULL).  If the file can't be opened, the
+//	trace is printed as text instead.
+//----------------------------------------------------------------------
+
+SchedTrace::SchedTrace(char *fileName)
+{
+    int magic = TraceMagic;
+
+    buffer = NULL;
+    fd = -1;
+    numInBuffer = numWritten = 0;
+    if (fileName == NULL || strcmp(fileName, "text") == 0)
+	mode = TraceText;
+    else if (strcmp(fileName, "off") == 0)
+	mode = TraceOff;
+    else if ((fd = OpenForWrite(fileName)) < 0) {
+	cout << "Couldn't write scheduler trace to " << fileName
+	    << ", printing it instead\n";
+	mode = TraceText;
+    } else {
+	mode = TraceBinary;
+	WriteFile(fd, (char *) &magic, sizeof(int));
+	buffer = new TraceEvent[TraceBufferSize];
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::~SchedTrace
+// 	Write out the events still in the buffer, and close the file.
+//----------------------------------------------------------------------
+
+SchedTrace::~SchedTrace()
+{
+    if (mode == TraceBinary) {
+	Flush();
+	Close(fd);
+	DEBUG(dbgThread, "Wrote " << numWritten << " scheduler events");
+	delete [] buffer;
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::Add
+// 	Record an event that happened now.  In text mode, print it; in
+//	binary mode, put it in the buffer, writing the buffer out first
+//	if it is full.
+//----------------------------------------------------------------------
+
+void
+SchedTrace::Add(int type, int thread, int arg1, int arg2)
+{
+    TraceEvent event;
+    TraceEvent *e = &event;
+
+    if (mode == TraceBinary) {
+	if (numInBuffer == TraceBufferSize)
+	    Flush();
+	e = &buffer[numInBuffer++];
+    }
+    e->tick = kernel->stats->totalTicks;
+    e->thread = thread;
+    e->type = type;
+    e->arg1 = arg1;
+    e->arg2 = arg2;
+    if (mode == TraceText)
+	e->Print();
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::Flush
+// 	Write the buffered events to the trace file, in one write, and
+//	start the buffer over.
+//----------------------------------------------------------------------
+
+void
+SchedTrace::Flush()
+{
+    if (numInBuffer > 0)
+	WriteFile(fd, (char *) buffer, numInBuffer * sizeof(TraceEvent));
+    numWritten += numInBuffer;
+    numInBuffer = 0;
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::Decode
+// 	Print every event in the binary trace file "fileName" as text.
+//	Called from main, before the kernel is started.
+//----------------------------------------------------------------------
+
+void
+SchedTrace::Decode(char *fileName)
+{
+    TraceEvent *events = new TraceEvent[TraceBufferSize];
+    int fd, magic = 0, numRead;
+
+    if ((fd = OpenForReadWrite(fileName, FALSE)) < 0) {
+	cout << "Decode: couldn't open trace file " << fileName << "\n";
+	delete [] events;
+	return;
+    }
+    if (ReadPartial(fd, (char *) &magic, sizeof(int)) != sizeof(int)
+		|| magic != TraceMagic) {
+	cout << "Decode: " << fileName << " is not a scheduler trace\n";
+    } else {
+	while ((numRead = ReadPartial(fd, (char *) events,
+			TraceBufferSize * sizeof(TraceEvent))) > 0) {
+	    for (int i = 0; i < numRead / (int) sizeof(TraceEvent); i++)
+		events[i].Print();
+	}
+    }
+    Close(fd);
+    delete [] events;
+}
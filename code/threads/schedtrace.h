@@ -0,0 +1,87 @@
+// schedtrace.h
+//	Data structures for the scheduler event trace.
+//
+//	Every scheduling event (a thread put on or taken off a ready
+//	queue, a priority change, a context switch) is recorded as a
+//	small fixed-size binary record, instead of formatting a line of
+//	text on the spot.  The trace can be
+//
+//	    text    print each event as it happens, in the MP3 format
+//		    ("Tick N: Thread X is inserted into queue L1"); this
+//		    is the default
+//	    off	    record nothing at all
+//	    binary  keep the events in a ring buffer in memory, and
+//		    write the whole buffer to a UNIX file when it fills
+//		    up and when Nachos halts
+//
+//	A binary trace is turned back into the text format offline,
+//	with "nachos -sd <file>".
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDTRACE_H
+#define SCHEDTRACE_H
+
+#include "copyright.h"
+
+// Number of events the ring buffer holds before it is written out.
+const int TraceBufferSize = 4096;
+
+// First word of a binary trace file, to recognize one.
+const int TraceMagic = 0x4e535452;	// "NSTR"
+
+enum TraceEventType {
+    TraceInserted,		// "thread" put on queue "arg1"
+    TraceRemoved,		// "thread" taken off queue "arg1"
+    TracePriority,		// priority changed from "arg1" to "arg2"
+    TraceSelected,		// "thread" is now running
+    TraceReplaced		// "thread" stopped after "arg1" ticks
+};
+
+enum TraceMode { TraceOff, TraceText, TraceBinary };
+
+// The following class defines one event record.  It is written to the
+// trace file as is, so keep it to plain ints.
+
+class TraceEvent {
+  public:
+    int tick;			// totalTicks when it happened
+    int thread;			// thread ID
+    int type;			// a TraceEventType
+    int arg1, arg2;
+
+    void Print();		// Print in the MP3 text format
+};
+
+// The following class defines the trace itself.
+
+class SchedTrace {
+  public:
+    SchedTrace(char *fileName);	// Trace to "fileName" in binary; "off"
+				// and "text" choose the other modes,
+				// NULL means text
+    ~SchedTrace();		// Write out what is left in the buffer
+
+    void Record(int type, int thread, int arg1 = 0, int arg2 = 0) {
+	if (mode != TraceOff)
+	    Add(type, thread, arg1, arg2);
+    }
+    bool IsOff() { return mode == TraceOff; }
+
+    static void Decode(char *fileName);
+				// Print a binary trace file as text
+
+  private:
+    TraceMode mode;
+    int fd;			// UNIX file a binary trace goes to
+    TraceEvent *buffer;		// the ring buffer, binary mode only
+    int numInBuffer;
+    int numWritten;		// events written to the file so far
+
+    void Add(int type, int thread, int arg1, int arg2);
+    void Flush();		// Write the buffer to the file
+};
+
+#endif // SCHEDTRACE_H
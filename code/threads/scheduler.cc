@@ -11,8 +11,8 @@
 //	end up calling FindNextToRun(), and that would put us in an
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	The order in which ready threads run is up to the scheduling
+//	policy; see schedpolicy.cc.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -28,94 +28,23 @@ using namespace std;
 
 //----------------------------------------------------------------------
 // Scheduler::Scheduler
-// 	Initialize the list of ready but not running threads.
-//	Initially, no ready threads.
+// 	Initialize the ready queues.  Initially, no ready threads.
+//
+//	"policyName" is the scheduling policy to use; see schedpolicy.h
+//	"config" holds its parameters
 //----------------------------------------------------------------------
 
-
-/* MP3 Compare func */
-int burstCmp(Thread *a, Thread *b)
-{
-    int aTime = a->getBurstTime();
-    int bTime = b->getBurstTime();
-    if(aTime == bTime)  return 0;
-    else if(aTime > bTime) return 1;
-    else return -1;
-}
-
-int priorityCmp(Thread *a, Thread *b)
-{
-    int aPriority = a->getPriority();
-    int bPriority = b->getPriority();
-    if(aPriority == bPriority)  return 0;
-    else if(aPriority > bPriority) return -1;
-    else return 1;
-}
-
-/* MP3 Check aging */
-bool Scheduler::CheckAging(Thread *thread)
+Scheduler::Scheduler(char *policyName, SchedConfig *config)
 {
-    int nowTime = kernel->stats->totalTicks;
-    /* In ready queue and wait time >= 1500 */
-    if(thread->getStatus() == READY && nowTime - thread->getStartWaitTime() >= 1500)
-    {
-        /* Aging */
-        int oldPriority = thread->getPriority();
-        int newPriority = (oldPriority + 10 > 149) ? 149 : oldPriority + 10;
-        thread->setPriority(newPriority);
-        if(oldPriority != newPriority){
-          cout << "Tick " << nowTime << ": Thread " << thread->getID();
-          cout << " changes its priority from " << oldPriority << " to " << newPriority << endl;
-        }
-
-        if(newPriority >= 100 && newPriority < 110) /* L2 -> L1 */
-        {
-            if(kernel->scheduler->L2Queue->IsInList(thread))
-                kernel->scheduler->L2Queue->Remove(thread);
-            kernel->scheduler->L1Queue->Insert(thread);
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is removed from queue L2" << endl;
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L1"<< endl;
-
-            /* Preemptive , Only SJF */
-            if( 100 <= kernel->currentThread->getPriority() && kernel->currentThread->getPriority() <= 149 )
-            {
-   	          if(kernel->currentThread->getID() != thread->getID())
-              {
-   	            double actBurst = kernel->stats->userTicks - kernel->currentThread->getStartTime();
-		            double estBurst = 0.5 * actBurst + 0.5 * kernel->currentThread->getBurstTime();
-                if(thread->getBurstTime() < estBurst)
-                  kernel->currentThread->Yield();
-              }
-            }
-            /* Reset wait time */
-            thread->setStartWaitTime(nowTime);
-            return TRUE;
-        }
-        else if(newPriority >= 50 && newPriority < 60) /* L3 -> L2 */
-        {
-            kernel->scheduler->readyList->Remove(thread);
-            kernel->scheduler->L2Queue->Insert(thread);
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is removed from queue L3" << endl;
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L2" << endl;
-        }
-        /* Reset wait time */
-        thread->setStartWaitTime(nowTime);
-    }
-    return FALSE;
-}
-
-Scheduler::Scheduler()
-{
-    readyList = new List<Thread *>;
+    policy = NewSchedulingPolicy(policyName, config);
+    if (policy == NULL)
+	cout << "Unknown scheduling policy: " << policyName << "\n";
+    ASSERT(policy != NULL);
     toBeDestroyed = NULL;
-
-    /* MP3 Init Queue */
-    L1Queue = new SortedList<Thread *>(burstCmp);
-    L2Queue = new SortedList<Thread *>(priorityCmp);
+    numSwitches = 0;
+    lastSpace = NULL;
 }
 
-
-
 //----------------------------------------------------------------------
 // Scheduler::~Scheduler
 // 	De-allocate the list of ready threads.
@@ -123,62 +52,61 @@ Scheduler::Scheduler()
 
 Scheduler::~Scheduler()
 {
-    delete readyList;
+    delete policy;
 }
 
 //----------------------------------------------------------------------
 // Scheduler::ReadyToRun
 // 	Mark a thread as ready, but not running.
 //	Put it on the ready list, for later scheduling onto the CPU.
+//	If the policy says so, it takes the CPU away from the current
+//	thread at once -- unless "mayPreempt" is FALSE: the current
+//	thread is about to block, and must not be put on the ready
+//	list while it is already on a wait queue.
 //
 //	"thread" is the thread to be put on the ready list.
 //----------------------------------------------------------------------
 
 void
-Scheduler::ReadyToRun (Thread *thread)
+Scheduler::ReadyToRun (Thread *thread, bool mayPreempt)
 {
     ASSERT(kernel->interrupt->getLevel() == IntOff);
     DEBUG(dbgThread, "Putting thread on ready list: " << thread->getName());
 	//cout << "Putting thread on ready list: " << thread->getName() << endl ;
     thread->setStatus(READY);
 
-    /* MP3 into queue */
-    int p = thread->getPriority();
-    int nowTime = kernel->stats->totalTicks;
-    cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L";
-    if(100 <=  p && p <= 149)
-	{
-        L1Queue->Insert(thread);
-        cout << 1 << endl;
-    }
-	else if(50 <= p && p <= 99)
-    {
-		L2Queue->Insert(thread);
-        cout << 2 << endl;
-    }
-	else
-    {
-     readyList->Append(thread);
-     cout << 3 << endl;
-    }
-
     /* MP3 Aging , now thread starts to wait */
-    thread->setStartWaitTime(nowTime);
-
-    /* MP3 preemptive , only SJF */
-    if(100 <=  p && p <= 149) /* something is added into L1 queue */
-    {
-        if( 100 <= kernel->currentThread->getPriority() && kernel->currentThread->getPriority() <= 149 )
-        {
-          if(kernel->currentThread->getID() != thread->getID())
-          {
-   	        double actBurst = kernel->stats->userTicks - kernel->currentThread->getStartTime();
-		        double estBurst = 0.5 * actBurst + 0.5 * kernel->currentThread->getBurstTime();
-            if(thread->getBurstTime() < estBurst)
-              kernel->currentThread->Yield();
-          }
-        }
-    }
+    thread->setStartWaitTime(kernel->stats->totalTicks);
+    policy->Enqueue(thread);
+    kernel->alarm->CheckTimer();	// someone to slice for, now?
+
+    /* MP3 preemptive */
+    if (mayPreempt && policy->ShouldPreempt(thread))
+        kernel->currentThread->Yield();
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetPriority
+// 	Change the priority of "thread".  A ready thread is moved by
+//	the policy to where its new priority belongs; a running or
+//	blocked one only has its priority changed.  Used by locks to
+//	donate priority to the thread holding them.
+//----------------------------------------------------------------------
+
+void
+Scheduler::SetPriority(Thread *thread, int priority)
+{
+    int oldPriority = thread->getPriority();
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    if (priority == oldPriority)
+	return;
+    kernel->schedTrace->Record(TracePriority, thread->getID(),
+    				oldPriority, priority);
+    if (thread->getStatus() == READY)
+	policy->Reprioritize(thread, priority);
+    else
+	thread->setPriority(priority);
 }
 
 //----------------------------------------------------------------------
@@ -194,31 +122,35 @@ Scheduler::FindNextToRun ()
 {
     ASSERT(kernel->interrupt->getLevel() == IntOff);
 
-    /* MP3 Which is Next ? */
-    int nowTime = kernel->stats->totalTicks;
-    if(!L1Queue->IsEmpty())
-    {
-        cout << "Tick " << nowTime << ": Thread " << L1Queue->Front()->getID() << " is removed from queue L";
-        cout << 1 << endl;
+    return policy->Dequeue();
+}
 
-        return L1Queue->RemoveFront();
-    }
-    else if(!L2Queue->IsEmpty())
-    {
-        cout << "Tick " << nowTime << ": Thread " << L2Queue->Front()->getID() << " is removed from queue L";
-        cout << 2 << endl;
+//----------------------------------------------------------------------
+// Scheduler::Preemptible
+// 	Return TRUE if the timer may take the CPU away from the current
+//	thread when its time slice is up.
+//----------------------------------------------------------------------
 
-        return L2Queue->RemoveFront();
-    }
-    else if (!readyList->IsEmpty())
-    {
-        cout << "Tick " << nowTime << ": Thread " << readyList->Front()->getID() << " is removed from queue L";
-        cout << 3 << endl;
+bool
+Scheduler::Preemptible()
+{
+    return policy->Preemptible(kernel->currentThread);
+}
 
-        return readyList->RemoveFront();
-    }
-    else
-        return NULL;
+//----------------------------------------------------------------------
+// Scheduler::NeedsTimeSlice
+// 	Return TRUE if a timer interrupt could switch threads: some
+//	thread is ready, and a thread is running that may be sliced.
+//	Used to stop the timer in tickless mode.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::NeedsTimeSlice()
+{
+    Thread *current = kernel->currentThread;
+
+    return !policy->IsEmpty() && current->getStatus() == RUNNING
+    		&& policy->Preemptible(current);
 }
 
 //----------------------------------------------------------------------
@@ -245,15 +177,14 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 
     /* MP3 thread start */
 
-    int nowTime = kernel->stats->totalTicks;
     int nowUserTime = kernel->stats->userTicks;
 
     nextThread->setStartTime(nowUserTime);
     int oldThreadTime = nowUserTime - oldThread->getStartTime();
 
-    cout << "Tick " << nowTime << ": Thread " << nextThread->getID() <<" is now selected for execution" << endl;
-    cout << "Tick " << nowTime << ": Thread " << oldThread->getID() <<" is replaced, and it has executed ";
-    cout << oldThreadTime << " ticks" << endl;
+    kernel->schedTrace->Record(TraceSelected, nextThread->getID());
+    kernel->schedTrace->Record(TraceReplaced, oldThread->getID(),
+    				oldThreadTime);
 
 
     ASSERT(kernel->interrupt->getLevel() == IntOff);
@@ -263,16 +194,21 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 	 toBeDestroyed = oldThread;
     }
 
-    if (oldThread->space != NULL) {	// if this thread is a user program,
-        oldThread->SaveUserState(); 	// save the user's CPU registers
-	oldThread->space->SaveState();
-    }
-
     oldThread->CheckOverflow();		    // check if the old thread
 					    // had an undetected stack overflow
 
     kernel->currentThread = nextThread;  // switch to the next thread
+    numSwitches++;
     nextThread->setStatus(RUNNING);      // nextThread is now running
+    // A user program's registers stay in its Thread, so there is
+    // nothing to save; and the MMU keeps the last address space loaded
+    // until another user program runs, so switching to a kernel thread
+    // and back to the same program reloads nothing.
+    if (nextThread->space != NULL) {	    // if it is a user program,
+	nextThread->RestoreUserState();	    // point the CPU at its registers
+	LoadSpace(nextThread->space);
+    }
+    kernel->alarm->CheckTimer();	    // may it be sliced?
 
     DEBUG(dbgThread, "Switching from: " << oldThread->getName() << " to: " << nextThread->getName());
 
@@ -299,10 +235,39 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 					// before this one has finished
 					// and needs to be cleaned up
 
-    if (oldThread->space != NULL) {	    // if there is an address space
-        oldThread->RestoreUserState();     // to restore, do it.
-	oldThread->space->RestoreState();
-    }
+    // our registers and address space were restored by whoever
+    // switched back to us
+}
+
+//----------------------------------------------------------------------
+// Scheduler::LoadSpace
+// 	Make "space" the address space the MMU translates with.  The one
+//	loaded before is saved first; nothing is done if "space" is
+//	already loaded.
+//----------------------------------------------------------------------
+
+void
+Scheduler::LoadSpace(AddrSpace *space)
+{
+    if (space == lastSpace)
+	return;
+    if (lastSpace != NULL)
+	lastSpace->SaveState();
+    space->RestoreState();
+    lastSpace = space;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ForgetSpace
+// 	"space" is being deleted; if it is the one in the MMU, there is
+//	nothing left to save when the next program is loaded.
+//----------------------------------------------------------------------
+
+void
+Scheduler::ForgetSpace(AddrSpace *space)
+{
+    if (space == lastSpace)
+	lastSpace = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -330,6 +295,6 @@ Scheduler::CheckToBeDestroyed()
 void
 Scheduler::Print()
 {
-    cout << "Ready list contents:\n";
-    readyList->Apply(ThreadPrint);
+    cout << "Ready list contents (" << policy->Name() << "):\n";
+    policy->Print();
 }
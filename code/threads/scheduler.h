@@ -12,18 +12,25 @@
 #include "copyright.h"
 #include "list.h"
 #include "thread.h"
+#include "schedpolicy.h"
 
 // The following class defines the scheduler/dispatcher abstraction --
 // the data structures and operations needed to keep track of which
 // thread is running, and which threads are ready but not running.
+// Which ready thread runs next is decided by a SchedulingPolicy.
 
 class Scheduler {
   public:
-    Scheduler();		// Initialize list of ready threads
+    Scheduler(char *policyName, SchedConfig *config);
+    				// Initialize list of ready threads, kept
+    				// by the policy called "policyName"
     ~Scheduler();		// De-allocate ready list
 
-    void ReadyToRun(Thread* thread);
+    void ReadyToRun(Thread* thread) { ReadyToRun(thread, TRUE); }
     				// Thread can be dispatched.
+    void ReadyToRun(Thread* thread, bool mayPreempt);
+    				// ... but never preempt the current
+				// thread if !mayPreempt
     Thread* FindNextToRun();	// Dequeue first thread on the ready
 				// list, if any, and return thread.
     void Run(Thread* nextThread, bool finishing);
@@ -31,23 +38,34 @@ class Scheduler {
     void CheckToBeDestroyed();// Check if thread that had been
     				// running needs to be deleted
     void Print();		// Print contents of ready list
+    char *PolicyName() { return policy->Name(); }
 
     // SelfTest for scheduler is implemented in class Thread
 
-    /* MP3 */
-    bool CheckAging(Thread *thread);
-    List<Thread *> *readyList;  // queue of threads that are ready to run,
-    /* MP3 add 2 more queue */
-    SortedList<Thread *> *L1Queue;
-    SortedList<Thread *> *L2Queue;
+    void Stopped(Thread *thread) { policy->Stopped(thread); }
+    				// The current thread gives up the CPU
+    bool Preemptible();		// May the timer slice the current thread?
+    bool NeedsTimeSlice();	// Could a time slice make a difference?
+    void Tick() { policy->Tick(); }
+				// Called on every tick
+    void SetPriority(Thread *thread, int priority);
+    				// Change the priority of "thread",
+				// moving it if it is ready
+    int NumSwitches() { return numSwitches; }
+    				// Context switches so far
+    void LoadSpace(AddrSpace *space);
+    				// Put "space" in the MMU, if it isn't
+    void ForgetSpace(AddrSpace *space);
+    				// "space" is being deleted
 
   private:
-
-				// but not running
+    SchedulingPolicy *policy;	// keeps the threads that are ready to
+				// run, but not running
     Thread *toBeDestroyed;	// finishing thread to be destroyed
     				// by the next thread that runs
-
-
+    int numSwitches;
+    AddrSpace *lastSpace;	// the address space in the MMU, NULL
+				// if none
 };
 
 #endif // SCHEDULER_H
@@ -1,7 +1,7 @@
 // synch.cc 
-//	Routines for synchronizing threads.  Three kinds of
-//	synchronization routines are defined here: semaphores, locks 
-//   	and condition variables.
+//	Routines for synchronizing threads.  Four kinds of
+//	synchronization routines are defined here: semaphores, locks,
+//   	condition variables and reader-writer locks.
 //
 // Any implementation of a synchronization routine needs some
 // primitive atomic operation.  We assume Nachos is running on
@@ -16,17 +16,16 @@
 // re-set the interrupt state back to its original value (whether
 // that be disabled or enabled).
 //
-// Once we'e implemented one set of higher level atomic operations,
-// we can implement others using that implementation.  We illustrate
-// this by implementing locks and condition variables on top of 
-// semaphores, instead of directly enabling and disabling interrupts.
+// Locks and condition variables turn interrupts off themselves, like
+// semaphores, rather than being built on top of semaphores: priority
+// inheritance needs the holder and the waiters, and a consistent view
+// of both, and a condition variable moves its waiters straight onto
+// the queue of the lock ("wait morphing"), so the lock keeps its own
+// queue of threads.  A lock is handed directly to the first thread
+// waiting for it when it is released.
 //
-// Locks are implemented using a semaphore to keep track of
-// whether the lock is held or not -- a semaphore value of 0 means
-// the lock is busy; a semaphore value of 1 means the lock is free.
-//
-// The implementation of condition variables using semaphores is
-// a bit trickier, as explained below under Condition::Wait.
+// Reader-writer locks are built the easy way, from a lock and two
+// condition variables.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -36,6 +35,20 @@
 #include "synch.h"
 #include "main.h"
 
+//----------------------------------------------------------------------
+// Profile
+// 	Return the counters for a primitive of kind "kind" called
+//	"name", or NULL if we are not profiling.
+//----------------------------------------------------------------------
+
+static SynchStats *
+Profile(char *kind, char *name)
+{
+    if (kernel->synchProfiler == NULL)
+	return NULL;
+    return kernel->synchProfiler->Register(kind, name);
+}
+
 //----------------------------------------------------------------------
 // Semaphore::Semaphore
 // 	Initialize a semaphore, so that it can be used for synchronization.
@@ -48,7 +61,8 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List<Thread *>;
+    queue = new ThreadQueue;
+    profile = Profile("semaphore", debugName);
 }
 
 //----------------------------------------------------------------------
@@ -64,28 +78,45 @@ Semaphore::~Semaphore()
 
 //----------------------------------------------------------------------
 // Semaphore::P
-// 	Wait until semaphore value > 0, then decrement.  Checking the
-//	value and decrementing must be done atomically, so we
+// 	Wait until semaphore value >= "n", then subtract "n".  Checking
+//	the value and decrementing must be done atomically, so we
 //	need to disable interrupts before checking the value.
 //
+//	While others are queued, we queue behind them even if the
+//	value would do, so that they are not overtaken.
+//
 //	Note that Thread::Sleep assumes that interrupts are disabled
 //	when it is called.
 //----------------------------------------------------------------------
 
 void
-Semaphore::P()
+Semaphore::P(int n)
 {
     Interrupt *interrupt = kernel->interrupt;
     Thread *currentThread = kernel->currentThread;
+    bool contended = FALSE;
+    int waited = 0;
     
+    ASSERT(n > 0);
+
     // disable interrupts
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	
     
-    while (value == 0) { 		// semaphore not available
-	queue->Append(currentThread);	// so go to sleep
-	currentThread->Sleep(FALSE);
-    } 
-    value--; 			// semaphore available, consume its value
+    if (value < n || !queue->IsEmpty()) {
+	contended = TRUE;
+	if (profile != NULL)
+	    kernel->synchProfiler->Blocked(currentThread, profile, NULL);
+	do {				// semaphore not available
+	    queue->Append(currentThread);	// so go to sleep
+	    currentThread->semaphoreWant = n;
+	    currentThread->Sleep(FALSE);
+	} while (value < n);
+	if (profile != NULL)
+	    waited = kernel->synchProfiler->Unblocked(currentThread);
+    }
+    value -= n;			// semaphore available, consume its value
+    if (profile != NULL)
+	profile->Acquired(contended, waited);
    
     // re-enable interrupts
     (void) interrupt->SetLevel(oldLevel);	
@@ -93,29 +124,55 @@ Semaphore::P()
 
 //----------------------------------------------------------------------
 // Semaphore::V
-// 	Increment semaphore value, waking up a waiter if necessary.
-//	As with P(), this operation must be atomic, so we need to disable
-//	interrupts.  Scheduler::ReadyToRun() assumes that interrupts
-//	are disabled when it is called.
+// 	Add "n" to the semaphore value, and wake up the waiters at the
+//	front of the queue that the new value satisfies, all in one
+//	pass.  As with P(), this operation must be atomic, so we need
+//	to disable interrupts.  Scheduler::ReadyToRun() assumes that
+//	interrupts are disabled when it is called.
 //----------------------------------------------------------------------
 
 void
-Semaphore::V()
+Semaphore::V(int n)
 {
     Interrupt *interrupt = kernel->interrupt;
+    int left;
     
+    ASSERT(n > 0);
+
     // disable interrupts
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	
     
-    if (!queue->IsEmpty()) {  // make thread ready.
+    value += n;
+    left = value;
+    while (!queue->IsEmpty() && queue->Front()->semaphoreWant <= left) {
+	left -= queue->Front()->semaphoreWant;	// make thread ready.
 	kernel->scheduler->ReadyToRun(queue->RemoveFront());
     }
-    value++;
     
     // re-enable interrupts
     (void) interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Semaphore::operator new, Semaphore::operator delete
+// 	Take the room for a semaphore from a pool, and give it back
+//	there (see pool.h).
+//----------------------------------------------------------------------
+
+static ObjectPool semaphorePool("semaphore", sizeof(Semaphore));
+
+void *
+Semaphore::operator new(size_t size)
+{
+    return semaphorePool.Alloc(size);
+}
+
+void
+Semaphore::operator delete(void *semaphore, size_t size)
+{
+    semaphorePool.Free(semaphore, size);
+}
+
 //----------------------------------------------------------------------
 // Semaphore::SelfTest, SelfTestHelper
 // 	Test the semaphore implementation, by using a semaphore
@@ -132,6 +189,13 @@ SelfTestHelper (Semaphore *pong)
     }
 }
 
+static void
+BatchHelper (Semaphore *done)
+{
+    ping->P(2);
+    done->V();
+}
+
 void
 Semaphore::SelfTest()
 {
@@ -145,6 +209,17 @@ Semaphore::SelfTest()
 	this->P();
     }
     delete ping;
+
+    // batches: three threads each wait for 2, and one V(6) lets
+    // all of them through
+    ping = new Semaphore("batch", 0);
+    for (int i = 0; i < 3; i++)
+	(new Thread("batch", 1))->Fork((VoidFunctionPtr) BatchHelper, this);
+    kernel->currentThread->Yield();	// let them get in line
+    ping->V(6);
+    this->P(3);
+    ASSERT(value == 0 && ping->value == 0);
+    delete ping;
 }
 
 //----------------------------------------------------------------------
@@ -158,8 +233,10 @@ Semaphore::SelfTest()
 Lock::Lock(char* debugName)
 {
     name = debugName;
-    semaphore = new Semaphore("lock", 1);  // initially, unlocked
-    lockHolder = NULL;
+    lockHolder = NULL;			// initially, unlocked
+    waiters = new ThreadQueue;
+    profile = Profile("lock", debugName);
+    acquiredAt = 0;
 }
 
 //----------------------------------------------------------------------
@@ -168,38 +245,277 @@ Lock::Lock(char* debugName)
 //----------------------------------------------------------------------
 Lock::~Lock()
 {
-    delete semaphore;
+    delete waiters;
 }
 
 //----------------------------------------------------------------------
 // Lock::Acquire
 //	Atomically wait until the lock is free, then set it to busy.
-//	Equivalent to Semaphore::P(), with the semaphore value of 0
-//	equal to busy, and semaphore value of 1 equal to free.
+//	A thread that has to wait is handed the lock by Release, so
+//	when it wakes up, the lock is already its own.
+//
+//	If the lock is busy, lend our priority to the holder first.
+//
+//	When profiling, a waiter's acquisition is counted by Release,
+//	which knows when it got the lock.
 //----------------------------------------------------------------------
 
 void Lock::Acquire()
 {
-    semaphore->P();
-    lockHolder = kernel->currentThread;
+    Thread *current = kernel->currentThread;
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    if (lockHolder == NULL) {
+	lockHolder = current;
+	current->heldLocks->Append(this);
+	if (profile != NULL) {
+	    profile->Acquired(FALSE, 0);
+	    acquiredAt = kernel->stats->totalTicks;
+	}
+    } else {
+	Enqueue(current);
+	current->Sleep(FALSE);
+    }
+    ASSERT(lockHolder == current);
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Lock::Enqueue
+//	Put "thread" at the end of the queue of threads waiting for
+//	the lock, and lend it priority.  Called by Acquire for the
+//	current thread, and by Condition::Signal to move a waiter from
+//	the condition straight to the lock ("wait morphing"), so that it
+//	does not wake up only to find the lock busy.
+//
+//	Assumes interrupts are off, and the lock is busy.
+//----------------------------------------------------------------------
+
+void
+Lock::Enqueue(Thread *thread)
+{
+    ASSERT(lockHolder != NULL && thread != lockHolder);
+    thread->waitingFor = this;
+    waiters->Append(thread);
+    if (profile != NULL)
+	kernel->synchProfiler->Blocked(thread, profile, this);
+    Donate(thread->getPriority());
 }
 
 //----------------------------------------------------------------------
 // Lock::Release
-//	Atomically set lock to be free, waking up a thread waiting
-//	for the lock, if any.
-//	Equivalent to Semaphore::V(), with the semaphore value of 0
-//	equal to busy, and semaphore value of 1 equal to free.
+//	Atomically set lock to be free, or hand it to the first thread
+//	waiting for it, if any, and wake that thread up.
+//
+//	If we were lent a priority, drop back to the highest of our
+//	own and those of the threads waiting for the locks we still
+//	hold, before the waiter we wake up can run.
 //
 //	By convention, only the thread that acquired the lock
 // 	may release it.
+//
+//	"mayPreempt" is FALSE if the waiter we wake up must not take
+//	the CPU from us, even if it should (see Condition::Wait).
 //---------------------------------------------------------------------
 
-void Lock::Release()
+void Lock::Release(bool mayPreempt)
 {
+    Thread *current = kernel->currentThread;
+    IntStatus oldLevel;
+    ListIterator<Lock *> *iter;
+    Thread *next;
+    int priority;
+
     ASSERT(IsHeldByCurrentThread());
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    if (profile != NULL)
+	profile->Held(kernel->stats->totalTicks - acquiredAt);
     lockHolder = NULL;
-    semaphore->V();
+    current->heldLocks->Remove(this);
+
+    if (current->ownPriority >= 0) {
+	priority = current->ownPriority;
+	iter = new ListIterator<Lock *>(current->heldLocks);
+	for (; !iter->IsDone(); iter->Next())
+	    priority = max(priority, iter->Item()->WaiterPriority());
+	delete iter;
+	if (priority == current->ownPriority)
+	    current->ownPriority = -1;		// nothing lent any more
+	kernel->scheduler->SetPriority(current, priority);
+    }
+    if (!waiters->IsEmpty()) {		// hand the lock over
+	next = waiters->RemoveFront();
+	next->waitingFor = NULL;
+	lockHolder = next;
+	next->heldLocks->Append(this);
+	if (profile != NULL) {
+	    profile->Acquired(TRUE, kernel->synchProfiler->Unblocked(next));
+	    acquiredAt = kernel->stats->totalTicks;
+	}
+	Donate(WaiterPriority());	// the others lend to the new holder
+	kernel->scheduler->ReadyToRun(next, mayPreempt);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Lock::WaiterPriority
+//	Return the highest priority of the threads waiting for the
+//	lock, or -1 if nobody is waiting.
+//----------------------------------------------------------------------
+
+int
+Lock::WaiterPriority()
+{
+    ThreadQueueIterator iter(waiters);
+    int priority = -1;
+
+    for (; !iter.IsDone(); iter.Next())
+	priority = max(priority, iter.Item()->getPriority());
+    return priority;
+}
+
+//----------------------------------------------------------------------
+// Lock::Donate
+//	Raise the holder of the lock to "priority", if it is lower.  If
+//	the holder is itself waiting for a lock, its holder is raised
+//	too, and so on down the chain.  The chain ends at a thread that
+//	is not waiting, or already has at least "priority", so a
+//	deadlock cycle does not make us loop forever.
+//
+//	The priority a thread had before the first donation is kept in
+//	ownPriority, so that Release can give it back.
+//----------------------------------------------------------------------
+
+void
+Lock::Donate(int priority)
+{
+    Lock *lock = this;
+    Thread *holder;
+
+    while (lock != NULL && (holder = lock->lockHolder) != NULL
+    		&& holder->getPriority() < priority) {
+	DEBUG(dbgThread, "Thread " << holder->getName() << " inherits priority "
+		<< priority << " through lock " << lock->name);
+	if (holder->ownPriority < 0)
+	    holder->ownPriority = holder->getPriority();
+	kernel->scheduler->SetPriority(holder, priority);
+	lock = holder->waitingFor;
+    }
+}
+
+//----------------------------------------------------------------------
+// Lock::SelfTest, Inversion*
+// 	Show what priority inheritance buys.  A low priority thread
+//	takes a mutex and starts a high and a medium priority thread;
+//	the high one wants the mutex, the medium one only computes.
+//	Without inheritance, the medium thread keeps the holder -- and
+//	so the high thread -- off the CPU until it is done.  With it,
+//	the holder runs at the high priority and gets out of the way
+//	first.
+//
+//	The scenario is played once with a bare semaphore as the mutex,
+//	the way locks used to be, and once with this lock, and the time
+//	the high priority thread waited is printed for both.  With the
+//	MLFQ policy, the second must be shorter.
+//----------------------------------------------------------------------
+
+static const int InversionWork = 50;	// OneTicks of computing
+
+static Lock *inversionLock;		// the mutex, if it is a lock
+static Semaphore *inversionMutex;	// the mutex, if it is not
+static Semaphore *inversionDone;	// V'ed by each thread at the end
+static int inversionWait;		// ticks the high thread waited
+
+static void
+InversionCompute()
+{
+    for (int i = 0; i < InversionWork; i++)
+	kernel->interrupt->OneTick();
+}
+
+static void
+InversionAcquire()
+{
+    if (inversionLock != NULL)
+	inversionLock->Acquire();
+    else
+	inversionMutex->P();
+}
+
+static void
+InversionRelease()
+{
+    if (inversionLock != NULL)
+	inversionLock->Release();
+    else
+	inversionMutex->V();
+}
+
+static void
+InversionHigh(void *arg)
+{
+    int start = kernel->stats->totalTicks;
+
+    InversionAcquire();
+    inversionWait = kernel->stats->totalTicks - start;
+    InversionRelease();
+    inversionDone->V();
+}
+
+static void
+InversionMedium(void *arg)
+{
+    InversionCompute();
+    inversionDone->V();
+}
+
+static void
+InversionLow(void *arg)
+{
+    SchedConfig *config = kernel->schedConfig;
+
+    InversionAcquire();
+    (new Thread("high", 1, config->l1Priority))->Fork(
+    				(VoidFunctionPtr) InversionHigh, NULL);
+    (new Thread("medium", 2, config->l2Priority))->Fork(
+    				(VoidFunctionPtr) InversionMedium, NULL);
+    kernel->currentThread->Yield();	// let them get going
+    InversionCompute();
+    InversionRelease();
+    inversionDone->V();
+}
+
+static int
+InversionRun()
+{
+    inversionDone = new Semaphore("done", 0);
+    (new Thread("low", 3, 0))->Fork((VoidFunctionPtr) InversionLow, NULL);
+    for (int i = 0; i < 3; i++)
+	inversionDone->P();
+    delete inversionDone;
+    return inversionWait;
+}
+
+void
+Lock::SelfTest()
+{
+    int without, with;
+
+    ASSERT(lockHolder == NULL);		// otherwise test won't work!
+    inversionLock = NULL;
+    inversionMutex = new Semaphore("mutex", 1);
+    without = InversionRun();
+    delete inversionMutex;
+
+    inversionLock = this;
+    with = InversionRun();
+
+    cout << "Priority inversion: high priority thread waited " << without
+	<< " ticks without inheritance, " << with << " ticks with it\n";
+    if (strcmp(kernel->scheduler->PolicyName(), "mlfq") == 0) {
+	ASSERT(with < without);
+    }
 }
 
 //----------------------------------------------------------------------
@@ -213,7 +529,8 @@ void Lock::Release()
 Condition::Condition(char* debugName)
 {
     name = debugName;
-    waitQueue = new List<Semaphore *>;
+    waitQueue = new ThreadQueue;
+    profile = Profile("condition", debugName);
 }
 
 //----------------------------------------------------------------------
@@ -228,70 +545,339 @@ Condition::~Condition()
 
 //----------------------------------------------------------------------
 // Condition::Wait
-// 	Atomically release monitor lock and go to sleep.
-//	Our implementation uses semaphores to implement this, by
-//	allocating a semaphore for each waiting thread.  The signaller
-//	will V() this semaphore, so there is no chance the waiter
-//	will miss the signal, even though the lock is released before
-//	calling P().
+// 	Atomically release monitor lock and go to sleep.  The waiting
+//	thread itself goes on the queue; no memory is allocated.  With
+//	interrupts off, the signaller cannot get in between releasing
+//	the lock and going to sleep, so the signal cannot be missed.
+//	Nor may the thread we hand the lock to preempt us in between:
+//	we would be on the ready list and on the queue at once.
 //
-//	Note: we assume Mesa-style semantics, which means that the
-//	waiter must re-acquire the monitor lock when waking up.
+//	Signal does not wake us, but moves us to the queue of the lock
+//	(see there); by the time we run again, Release has handed us
+//	the lock, and we return holding it.
+//
+//	Note: we assume Mesa-style semantics, which means that another
+//	thread may have had the lock, and changed things, between the
+//	signal and our return.
 //
 //	"conditionLock" -- lock protecting the use of this condition
 //----------------------------------------------------------------------
 
 void Condition::Wait(Lock* conditionLock) 
 {
-     Semaphore *waiter;
-    
-     ASSERT(conditionLock->IsHeldByCurrentThread());
+    Thread *current = kernel->currentThread;
+    IntStatus oldLevel;
+
+    ASSERT(conditionLock->IsHeldByCurrentThread());
 
-     waiter = new Semaphore("condition", 0);
-     waitQueue->Append(waiter);
-     conditionLock->Release();
-     waiter->P();
-     conditionLock->Acquire();
-     delete waiter;
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    waitQueue->Append(current);
+    if (profile != NULL)
+	kernel->synchProfiler->Blocked(current, profile, NULL);
+    conditionLock->Release(FALSE);
+    current->Sleep(FALSE);
+    ASSERT(conditionLock->IsHeldByCurrentThread());
+    (void) kernel->interrupt->SetLevel(oldLevel);
 }
 
 //----------------------------------------------------------------------
 // Condition::Signal
-// 	Wake up a thread waiting on this condition, if any.
+// 	Let a thread waiting on this condition go on, if any.
+//
+//	The thread is not made ready -- it could not run anyway until
+//	we release the lock -- but moved to the queue of the lock
+//	("wait morphing"); Release will hand it the lock and wake it.
 //
 //	Note: we assume Mesa-style semantics, which means that the
 //	signaller doesn't give up control immediately to the thread
 //	being woken up (unlike Hoare-style).
 //
 //	Also note: we assume the caller holds the monitor lock
-//	(unlike what is described in Birrell's paper).  This allows
-//	us to access waitQueue without disabling interrupts.
+//	(unlike what is described in Birrell's paper).
 //
 //	"conditionLock" -- lock protecting the use of this condition
 //----------------------------------------------------------------------
 
 void Condition::Signal(Lock* conditionLock)
 {
-    Semaphore *waiter;
-    
+    IntStatus oldLevel;
+
     ASSERT(conditionLock->IsHeldByCurrentThread());
-    
-    if (!waitQueue->IsEmpty()) {
-        waiter = waitQueue->RemoveFront();
-	waiter->V();
-    }
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    if (!waitQueue->IsEmpty())
+	Wake(conditionLock);
+    (void) kernel->interrupt->SetLevel(oldLevel);
 }
 
 //----------------------------------------------------------------------
 // Condition::Broadcast
-// 	Wake up all threads waiting on this condition, if any.
+// 	Let all threads waiting on this condition go on, if any.  They
+//	all move to the queue of the lock at once, and get the lock
+//	one after the other, instead of all waking up and fighting
+//	over it.
 //
 //	"conditionLock" -- lock protecting the use of this condition
 //----------------------------------------------------------------------
 
 void Condition::Broadcast(Lock* conditionLock) 
 {
-    while (!waitQueue->IsEmpty()) {
-        Signal(conditionLock);
-    }
+    IntStatus oldLevel;
+
+    ASSERT(conditionLock->IsHeldByCurrentThread());
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    while (!waitQueue->IsEmpty())
+	Wake(conditionLock);
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Condition::Wake
+// 	Move the first waiter to the queue of "conditionLock".  When
+//	profiling, its wait on the condition ends here, and its wait
+//	for the lock begins.
+//
+//	Assumes interrupts are off, and the queue is not empty.
+//----------------------------------------------------------------------
+
+void
+Condition::Wake(Lock *conditionLock)
+{
+    Thread *thread = waitQueue->RemoveFront();
+
+    if (profile != NULL)
+	profile->Acquired(TRUE, kernel->synchProfiler->Unblocked(thread));
+    conditionLock->Enqueue(thread);
+}
+
+//----------------------------------------------------------------------
+// Condition::SelfTest, Preempt*
+// 	Make Wait hand the lock to a thread that would preempt the
+//	waiter: two threads in the SJF queue (L1) of the MLFQ policy,
+//	the waiter with a long estimated burst and the other with none.
+//	The other one gets the lock, signals the waiter and lets go of
+//	the lock again.  Had the waiter been preempted inside Wait,
+//	it would now be made ready a second time.
+//
+//	Only the MLFQ policy preempts this way; with the others, this
+//	is just one more wait and signal.
+//----------------------------------------------------------------------
+
+static Lock *preemptLock;
+static Condition *preemptCondition;
+static Semaphore *preemptDone;
+static bool preemptSignalled;
+
+static void
+PreemptSignaller(void *arg)
+{
+    preemptLock->Acquire();		// handed over by Wait
+    preemptSignalled = TRUE;
+    preemptCondition->Signal(preemptLock);
+    preemptLock->Release();
+    preemptDone->V();
+}
+
+static void
+PreemptWaiter(void *arg)
+{
+    Thread *signaller;
+
+    preemptLock->Acquire();
+    signaller = new Thread("signaller", 1, kernel->schedConfig->l1Priority);
+    signaller->setBurstTime(0);
+    signaller->Fork((VoidFunctionPtr) PreemptSignaller, NULL);
+    while (!preemptSignalled)		// the signaller may run first,
+	preemptCondition->Wait(preemptLock);	// and wait for the lock
+    preemptLock->Release();
+    preemptDone->V();
+}
+
+void
+Condition::SelfTest()
+{
+    Thread *waiter;
+
+    ASSERT(waitQueue->IsEmpty());	// otherwise test won't work!
+    preemptLock = new Lock("preempt");
+    preemptCondition = this;
+    preemptDone = new Semaphore("preempt done", 0);
+    preemptSignalled = FALSE;
+
+    waiter = new Thread("waiter", 1, kernel->schedConfig->l1Priority);
+    waiter->setBurstTime(1000);		// long, so it is preempted
+    waiter->Fork((VoidFunctionPtr) PreemptWaiter, NULL);
+    preemptDone->P(2);
+
+    delete preemptDone;
+    delete preemptLock;
+}
+
+//----------------------------------------------------------------------
+// RWLock::RWLock
+// 	Initialize a reader-writer lock, so that it can be used for
+//	synchronization.  Initially, nobody holds it.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+RWLock::RWLock(char* debugName)
+{
+    name = debugName;
+    lock = new Lock(debugName);
+    readOK = new Condition(debugName);
+    writeOK = new Condition(debugName);
+    readers = 0;
+    waitingReaders = 0;
+    waitingWriters = 0;
+    writer = NULL;
+}
+
+//----------------------------------------------------------------------
+// RWLock::~RWLock
+// 	Deallocate a reader-writer lock.  Assume nobody holds it or
+//	waits for it.
+//----------------------------------------------------------------------
+
+RWLock::~RWLock()
+{
+    ASSERT(readers == 0 && writer == NULL);
+    delete writeOK;
+    delete readOK;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireRead
+// 	Wait until nobody writes or waits to, then hold the lock for
+//	reading, along with any other readers.
+//----------------------------------------------------------------------
+
+void
+RWLock::AcquireRead()
+{
+    lock->Acquire();
+    waitingReaders++;
+    while (writer != NULL || waitingWriters > 0)
+	readOK->Wait(lock);
+    waitingReaders--;
+    readers++;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// RWLock::ReleaseRead
+// 	Stop reading.  The last reader out lets a writer in.
+//----------------------------------------------------------------------
+
+void
+RWLock::ReleaseRead()
+{
+    lock->Acquire();
+    ASSERT(readers > 0);
+    readers--;
+    if (readers == 0)
+	writeOK->Signal(lock);
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireWrite
+// 	Wait until nobody holds the lock, then hold it alone.  Readers
+//	that come along in the meantime wait behind us.
+//----------------------------------------------------------------------
+
+void
+RWLock::AcquireWrite()
+{
+    lock->Acquire();
+    ASSERT(writer != kernel->currentThread);
+    waitingWriters++;
+    while (writer != NULL || readers > 0)
+	writeOK->Wait(lock);
+    waitingWriters--;
+    writer = kernel->currentThread;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// RWLock::ReleaseWrite
+// 	Stop writing.  The next writer goes first if there is one;
+//	otherwise every waiting reader is let in.
+//----------------------------------------------------------------------
+
+void
+RWLock::ReleaseWrite()
+{
+    lock->Acquire();
+    ASSERT(IsWriteHeldByCurrentThread());
+    writer = NULL;
+    if (waitingWriters > 0)
+	writeOK->Signal(lock);
+    else
+	readOK->Broadcast(lock);
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// RWLock::SelfTest, RWTest*
+// 	While the main thread holds the lock for reading, a second
+//	reader must get in too.  Then a writer queues up, and a third
+//	reader after it; when the readers are gone, the writer must get
+//	the lock before the reader that came after it.
+//----------------------------------------------------------------------
+
+static RWLock *rwTestLock;
+static int rwTestOrder[2];		// who got in, in order
+static int rwTestNumIn;
+static Semaphore *rwTestDone;
+
+static void
+RWTestReader(int who)
+{
+    rwTestLock->AcquireRead();
+    if (who > 0)
+	rwTestOrder[rwTestNumIn++] = who;
+    rwTestLock->ReleaseRead();
+    rwTestDone->V();
+}
+
+static void
+RWTestWriter(int who)
+{
+    rwTestLock->AcquireWrite();
+    rwTestOrder[rwTestNumIn++] = who;
+    rwTestLock->ReleaseWrite();
+    rwTestDone->V();
+}
+
+void
+RWLock::SelfTest()
+{
+    int priority = kernel->currentThread->getPriority();
+
+    ASSERT(readers == 0 && writer == NULL);  // otherwise test won't work!
+    rwTestLock = this;
+    rwTestNumIn = 0;
+    rwTestDone = new Semaphore("rw done", 0);
+
+    AcquireRead();
+    (new Thread("reader", 1, priority))->Fork(
+    				(VoidFunctionPtr) RWTestReader, (void *) 0);
+    rwTestDone->P();			// got in beside us
+
+    (new Thread("writer", 1, priority))->Fork(
+    				(VoidFunctionPtr) RWTestWriter, (void *) 1);
+    while (waitingWriters == 0)
+	kernel->currentThread->Yield();
+    (new Thread("reader", 1, priority))->Fork(
+    				(VoidFunctionPtr) RWTestReader, (void *) 2);
+    while (waitingReaders == 0)
+	kernel->currentThread->Yield();
+    ReleaseRead();
+
+    rwTestDone->P(2);
+    ASSERT(rwTestOrder[0] == 1 && rwTestOrder[1] == 2);
+    delete rwTestDone;
 }
@@ -1,8 +1,9 @@
 // synch.h 
 //	Data structures for synchronizing threads.
 //
-//	Three kinds of synchronization are defined here: semaphores,
-//	locks, and condition variables.  The implementation for
+//	Four kinds of synchronization are defined here: semaphores,
+//	locks, condition variables, and reader-writer locks built from
+//	the latter two.  The implementation for
 //	semaphores is given; for the latter two, only the procedure
 //	interface is given -- they are to be implemented as part of 
 //	the first assignment.
@@ -20,6 +21,7 @@
 #include "copyright.h"
 #include "thread.h"
 #include "list.h"
+#include "synchprof.h"
 #include "main.h"
 
 // The following class defines a "semaphore" whose value is a non-negative
@@ -36,6 +38,11 @@
 // into a register, a context switch might have occurred,
 // and some other thread might have called P or V, so the true value might
 // now be different.
+//
+// P(n) and V(n) take or give "n" at once.  Waiters are served in
+// order: V(n) wakes, in one pass, as many threads at the front of the
+// queue as the new value can satisfy, and a big request is not
+// overtaken by smaller ones queued after it.
 
 class Semaphore {
   public:
@@ -43,15 +50,22 @@ class Semaphore {
     ~Semaphore();   					// de-allocate semaphore
     char* getName() { return name;}			// debugging assist
     
-    void P();	 	// these are the only operations on a semaphore
-    void V();	 	// they are both *atomic*
+    void P() { P(1); }	// these are the only operations on a semaphore
+    void V() { V(1); }	// they are both *atomic*
+    void P(int n);	// wait until value >= n, then subtract n
+    void V(int n);	// add n, waking up the waiters it satisfies
     void SelfTest();	// test routine for semaphore implementation
+
+    void *operator new(size_t size);		// from a pool
+    void operator delete(void *semaphore, size_t size);
     
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List<Thread *> *queue;     
-		  	// threads waiting in P() for the value to be > 0
+    ThreadQueue *queue;     
+		  	// threads waiting in P() for the value to be > 0;
+			// each wants its semaphoreWant
+    SynchStats *profile;	// counters, if profiling (-lp)
    };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -65,6 +79,15 @@ class Semaphore {
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).  
+//
+// Locks do priority inheritance: a thread that has to wait for a lock
+// lends its priority to the holder, if that is higher, and to the
+// thread the holder is waiting for in turn, and so on.  Otherwise a
+// low priority holder could be kept off the CPU by medium priority
+// threads for as long as they like, and a high priority thread
+// waiting for it along with it.  The holder gets its own priority
+// back when it releases the lock (or the highest priority still
+// waiting for another lock it holds).
 
 class Lock {
   public:
@@ -73,19 +96,38 @@ class Lock {
     char* getName() { return name; }	// debugging assist
 
     void Acquire(); 		// these are the only operations on a lock
-    void Release(); 		// they are both *atomic*
+    void Release() { Release(TRUE); }	// they are both *atomic*
+    void Release(bool mayPreempt);
+    				// if !mayPreempt, the thread woken up
+				// does not take the CPU from us; for
+				// Condition::Wait, which is about to sleep
 
     bool IsHeldByCurrentThread() { 
     		return lockHolder == kernel->currentThread; }
     				// return true if the current thread 
 				// holds this lock.
     
-    // Note: SelfTest routine provided by SynchList
-    
+    int WaiterPriority();	// highest priority of the threads
+				// waiting for the lock, -1 if none
+    void Enqueue(Thread *thread);
+    				// make "thread" wait for the lock; for
+				// Condition, which moves its waiters here
+    Thread *Holder() { return lockHolder; }
+    				// for the deadlock report
+
+    void SelfTest();		// test priority inheritance; other
+    				// tests provided by SynchList
+
   private:
     char *name;			// debugging assist
     Thread *lockHolder;		// thread currently holding lock
-    Semaphore *semaphore;	// we use a semaphore to implement lock
+    ThreadQueue *waiters;	// threads waiting for the lock, in the
+				// order they get it
+    SynchStats *profile;	// counters, if profiling (-lp)
+    int acquiredAt;		// tick the holder got the lock
+
+    void Donate(int priority);	// lend "priority" to the holder, and
+				// on down the chain of holders
 };
 
 // The following class defines a "condition variable".  A condition
@@ -120,6 +162,12 @@ class Lock {
 // can acquire the lock, and change data structures, before the woken
 // thread gets a chance to run.  The advantage to Mesa-style semantics
 // is that it is a lot easier to implement than Hoare-style.
+//
+// Signal and Broadcast do not actually put anybody on the ready list:
+// a woken thread needs the lock first, which the signaller holds, so
+// it is moved from the condition to the queue of the lock instead
+// ("wait morphing"), and made ready when the lock is handed to it.
+// Broadcast thus causes no stampede for the lock.
 
 class Condition {
   public:
@@ -135,10 +183,62 @@ class Condition {
     void Signal(Lock *conditionLock);   // conditionLock must be held by
     void Broadcast(Lock *conditionLock);// the currentThread for all of 
 					// these operations
-    // SelfTest routine provided by SyncLists
+    void SelfTest();			// test that a waiter is not
+					// preempted on its way to sleep;
+					// other tests provided by SynchList
 
   private:
     char* name;
-    List<Semaphore *> *waitQueue;	// list of waiting threads
+    ThreadQueue *waitQueue;		// list of waiting threads
+    SynchStats *profile;		// counters, if profiling (-lp)
+
+    void Wake(Lock *conditionLock);	// move the first waiter to the lock
 };
+
+// The following class defines a "reader-writer lock".  Any number of
+// threads may hold it for reading at the same time, or a single
+// thread for writing:
+//
+//	AcquireRead -- wait until no thread holds the lock for writing
+//		or is waiting to, then hold it for reading
+//
+//	AcquireWrite -- wait until no thread holds the lock at all,
+//		then hold it for writing
+//
+// Writers have preference: once a writer waits, new readers wait
+// behind it, so that a steady stream of readers cannot keep it out
+// forever.  The flip side is that a thread must not acquire the lock
+// for reading a second time while it already holds it; a writer
+// queued in between would deadlock the two.
+//
+// When a writer releases the lock, another waiting writer gets it if
+// there is one; otherwise all waiting readers are let in together.
+
+class RWLock {
+  public:
+    RWLock(char* debugName);	// initialize lock to be FREE
+    ~RWLock();			// deallocate lock
+    char* getName() { return name; }	// debugging assist
+
+    void AcquireRead();		// shared access
+    void ReleaseRead();
+    void AcquireWrite();	// exclusive access
+    void ReleaseWrite();
+
+    bool IsWriteHeldByCurrentThread() {
+    		return writer == kernel->currentThread; }
+
+    void SelfTest();		// test sharing and writer preference
+
+  private:
+    char *name;			// debugging assist
+    Lock *lock;			// protects the fields below
+    Condition *readOK;		// wait here to read
+    Condition *writeOK;		// wait here to write
+    int readers;		// threads holding the lock for reading
+    int waitingReaders;		// threads waiting to read
+    int waitingWriters;		// threads waiting to write
+    Thread *writer;		// thread holding it for writing, if any
+};
+
 #endif // SYNCH_H
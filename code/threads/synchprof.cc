@@ -0,0 +1,270 @@
+// synchprof.cc
+//	Routines to profile the synchronization primitives, and to
+//	report deadlocks.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "synchprof.h"
+#include "synch.h"
+#include "main.h"
+
+//----------------------------------------------------------------------
+// SynchStats::SynchStats
+// 	Initialize the counters of the primitive(s) of kind "kind" with
+//	debug name "name".
+//----------------------------------------------------------------------
+
+SynchStats::SynchStats(char *kind, char *name)
+{
+    this->kind = kind;
+    this->name = name;
+    count = contended = 0;
+    waitTicks = maxWait = 0;
+    holdTicks = maxHold = 0;
+}
+
+//----------------------------------------------------------------------
+// SynchStats::Acquired, Held
+// 	Count one acquisition, and the ticks it waited; or the ticks a
+//	lock was held.
+//----------------------------------------------------------------------
+
+void
+SynchStats::Acquired(bool wasContended, int waited)
+{
+    count++;
+    if (wasContended) {
+	contended++;
+	waitTicks += waited;
+	maxWait = max(maxWait, waited);
+    }
+}
+
+void
+SynchStats::Held(int ticks)
+{
+    holdTicks += ticks;
+    maxHold = max(maxHold, ticks);
+}
+
+//----------------------------------------------------------------------
+// SynchStats::Print
+// 	Print one line of the profile.
+//----------------------------------------------------------------------
+
+void
+SynchStats::Print()
+{
+    cout << "  " << kind << " \"" << name << "\": " << count
+	<< " acquired, " << contended << " contended, waited "
+	<< waitTicks << " ticks (max " << maxWait << ")";
+    if (holdTicks > 0)
+	cout << ", held " << holdTicks << " ticks (max " << maxHold << ")";
+    cout << "\n";
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::SynchProfiler
+// 	Initialize the profiler.
+//----------------------------------------------------------------------
+
+SynchProfiler::SynchProfiler()
+{
+    stats = new List<SynchStats *>;
+    waits = new List<SynchWait *>;
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::~SynchProfiler
+// 	De-allocate the profiler.  The primitives must not report to it
+//	any more.
+//----------------------------------------------------------------------
+
+SynchProfiler::~SynchProfiler()
+{
+    while (!stats->IsEmpty())
+	delete stats->RemoveFront();
+    delete stats;
+    while (!waits->IsEmpty())
+	delete waits->RemoveFront();
+    delete waits;
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::Register
+// 	Return the counters for the primitives of kind "kind" and debug
+//	name "name", creating them for the first one.  The names are not
+//	copied; they are string constants, as a rule.
+//----------------------------------------------------------------------
+
+SynchStats *
+SynchProfiler::Register(char *kind, char *name)
+{
+    ListIterator<SynchStats *> iter(stats);
+    SynchStats *entry;
+
+    if (name == NULL)
+	name = "(unnamed)";
+    for (; !iter.IsDone(); iter.Next()) {
+	entry = iter.Item();
+	if (strcmp(entry->kind, kind) == 0 && strcmp(entry->name, name) == 0)
+	    return entry;
+    }
+    entry = new SynchStats(kind, name);
+    stats->Append(entry);
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::FindWait
+// 	Return what "thread" is blocked on, or NULL.
+//----------------------------------------------------------------------
+
+SynchWait *
+SynchProfiler::FindWait(Thread *thread)
+{
+    ListIterator<SynchWait *> iter(waits);
+
+    for (; !iter.IsDone(); iter.Next()) {
+	if (iter.Item()->thread == thread)
+	    return iter.Item();
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::Blocked
+// 	Record that "thread" is blocked on "on" -- which is the lock
+//	"lock", if it is a lock, else "lock" is NULL.  A thread moved
+//	from a condition variable to its lock is blocked on the lock
+//	from then on.
+//----------------------------------------------------------------------
+
+void
+SynchProfiler::Blocked(Thread *thread, SynchStats *on, Lock *lock)
+{
+    SynchWait *wait = FindWait(thread);
+
+    if (wait == NULL) {
+	wait = new SynchWait;
+	wait->thread = thread;
+	waits->Append(wait);
+    }
+    wait->on = on;
+    wait->lock = lock;
+    wait->since = kernel->stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::Unblocked
+// 	Record that "thread" no longer waits, and return for how many
+//	ticks it did.
+//----------------------------------------------------------------------
+
+int
+SynchProfiler::Unblocked(Thread *thread)
+{
+    SynchWait *wait = FindWait(thread);
+    int waited;
+
+    if (wait == NULL)
+	return 0;
+    waited = kernel->stats->totalTicks - wait->since;
+    waits->Remove(wait);
+    delete wait;
+    return waited;
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::CheckDeadlock
+// 	Called when no thread is ready and no interrupt is pending: the
+//	blocked threads can never run again.  Print each of them and
+//	what it waits for, then look for cycles in the wait-for graph,
+//	where each thread waits for a lock held by the next one.
+//----------------------------------------------------------------------
+
+void
+SynchProfiler::CheckDeadlock()
+{
+    ListIterator<SynchWait *> iter(waits);
+    ListIterator<SynchWait *> start(waits);
+    List<SynchWait *> told;	// threads on the cycles printed so far
+    SynchWait *wait, *next;
+    Thread *holder;
+    int now = kernel->stats->totalTicks;
+    unsigned int length;
+
+    if (waits->IsEmpty())
+	return;
+    cout << "Deadlock: " << waits->NumInList() << " thread(s) blocked forever\n";
+    for (; !iter.IsDone(); iter.Next()) {
+	wait = iter.Item();
+	cout << "  " << wait->thread->getName() << " waits for "
+	    << wait->on->kind << " \"" << wait->on->name << "\" since tick "
+	    << wait->since << " (" << now - wait->since << " ticks)";
+	if (wait->lock != NULL && wait->lock->Holder() != NULL)
+	    cout << ", held by " << wait->lock->Holder()->getName();
+	cout << "\n";
+    }
+
+    // Follow the chain of lock holders from each blocked thread, for
+    // at most as many steps as there are blocked threads; a cycle
+    // leads back to the start.  Each cycle is reported once.
+    for (; !start.IsDone(); start.Next()) {
+	wait = start.Item();
+	if (told.IsInList(wait))
+	    continue;
+	next = wait;
+	for (length = 0; length < waits->NumInList(); length++) {
+	    if (next->lock == NULL || (holder = next->lock->Holder()) == NULL)
+		break;
+	    next = FindWait(holder);
+	    if (next == NULL || next == wait)
+		break;
+	}
+	if (next != wait)
+	    continue;
+	cout << "  Cycle:";
+	do {
+	    told.Append(next);
+	    cout << " " << next->thread->getName() << " -> \""
+		<< next->lock->getName() << "\" ->";
+	    next = FindWait(next->lock->Holder());
+	} while (next != wait);
+	cout << " " << wait->thread->getName() << "\n";
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchProfiler::Print
+// 	Print the counters of every primitive that was used, those
+//	waited for longest first.
+//----------------------------------------------------------------------
+
+static int
+CompareWait(SynchStats *x, SynchStats *y)
+{
+    if (x->waitTicks != y->waitTicks)
+	return (x->waitTicks > y->waitTicks) ? -1 : 1;
+    if (x->count != y->count)
+	return (x->count > y->count) ? -1 : 1;
+    return 0;
+}
+
+void
+SynchProfiler::Print()
+{
+    SortedList<SynchStats *> sorted(CompareWait);
+    ListIterator<SynchStats *> iter(stats);
+
+    for (; !iter.IsDone(); iter.Next()) {
+	if (iter.Item()->count > 0)
+	    sorted.Insert(iter.Item());
+    }
+    cout << "Synchronization profile, in ticks:\n";
+    while (!sorted.IsEmpty())
+	sorted.RemoveFront()->Print();
+}
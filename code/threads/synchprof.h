@@ -0,0 +1,91 @@
+// synchprof.h
+//	Data structures for profiling the synchronization primitives,
+//	and for finding deadlocks.
+//
+//	When profiling is on ("-lp"), every semaphore, lock and
+//	condition variable reports to the profiler, which keeps, per
+//	kind and name (primitives with the same name are added up):
+//	how often it was acquired (P'ed, waited on), how often that
+//	had to wait, for how many ticks in all and at most, and for
+//	locks, how many ticks it was held.  The table is printed at
+//	halt, the primitives waited for longest first.
+//
+//	The profiler also knows which thread is blocked on what.  When
+//	the machine goes idle with nothing to run and nothing pending,
+//	every blocked thread is stuck for good; they are listed, along
+//	with any cycle of threads waiting for locks held by each other
+//	(following who holds each lock -- the wait-for graph).
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYNCHPROF_H
+#define SYNCHPROF_H
+
+#include "copyright.h"
+#include "list.h"
+
+class Thread;
+class Lock;
+
+// The following class defines the counters for one name.
+
+class SynchStats {
+  public:
+    SynchStats(char *kind, char *name);
+
+    void Acquired(bool contended, int waited);
+				// One more acquisition, which waited
+				// "waited" ticks if it was contended
+    void Held(int ticks);	// A lock was held for "ticks"
+    void Print();
+
+    char *kind;			// "semaphore", "lock" or "condition"
+    char *name;			// debug name
+    int count;			// acquisitions
+    int contended;		// ... that had to wait
+    int waitTicks, maxWait;	// time spent waiting
+    int holdTicks, maxHold;	// time held (locks only)
+};
+
+// The following class defines what a blocked thread waits for.
+
+class SynchWait {
+  public:
+    Thread *thread;
+    SynchStats *on;		// what it waits for
+    Lock *lock;			// the lock, if it waits for a lock
+    int since;			// tick it started waiting
+};
+
+// The following class defines the profiler.
+
+class SynchProfiler {
+  public:
+    SynchProfiler();		// Initialize empty tables
+    ~SynchProfiler();
+
+    SynchStats *Register(char *kind, char *name);
+				// The counters of primitive "name"
+
+    void Blocked(Thread *thread, SynchStats *on, Lock *lock);
+				// "thread" is going to sleep waiting for
+				// "on" (which is "lock", if a lock)
+    int Unblocked(Thread *thread);
+				// "thread" got what it waited for; return
+				// how many ticks it waited
+
+    void CheckDeadlock();	// Nothing can run; report who is stuck
+    void Print();		// Print the counters
+
+  private:
+    List<SynchStats *> *stats;	// one per kind and name
+    List<SynchWait *> *waits;	// one per blocked thread
+
+    SynchWait *FindWait(Thread *thread);
+				// What "thread" is blocked on, NULL if
+				// it is not
+};
+
+#endif // SYNCHPROF_H
@@ -0,0 +1,204 @@
+// synchring.cc
+//	Routines for a bounded, synchronized queue.
+//
+// 	The slow path is implemented in "monitor"-style, like SynchList:
+// 	a lock around the whole operation, and condition variables to
+//	wait for an item or for room.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "synchring.h"
+
+//----------------------------------------------------------------------
+// SynchRing<T>::SynchRing
+//	Allocate and initialize a synchronized ring that holds up to
+//	"capacity" items, empty to start with.
+//----------------------------------------------------------------------
+
+template <class T>
+SynchRing<T>::SynchRing(int capacity)
+{
+    ASSERT(capacity > 0);
+    items = new T[capacity];
+    this->capacity = capacity;
+    first = 0;
+    numInRing = 0;
+    numSlow = 0;
+    lock = new Lock("ring lock");
+    ringEmpty = new Condition("ring empty cond");
+    ringFull = new Condition("ring full cond");
+}
+
+//----------------------------------------------------------------------
+// SynchRing<T>::~SynchRing
+//	De-allocate the ring, and the items still in it.
+//----------------------------------------------------------------------
+
+template <class T>
+SynchRing<T>::~SynchRing()
+{
+    delete ringFull;
+    delete ringEmpty;
+    delete lock;
+    delete [] items;
+}
+
+//----------------------------------------------------------------------
+// SynchRing<T>::Put, Take
+//	Store an item at the end of the ring, or load the one at the
+//	front.  The caller has checked that there is room, or an item.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+SynchRing<T>::Put(T item)
+{
+    ASSERT(numInRing < capacity);
+    items[(first + numInRing) % capacity] = item;
+    numInRing++;
+}
+
+template <class T>
+T
+SynchRing<T>::Take()
+{
+    T item;
+
+    ASSERT(numInRing > 0);
+    item = items[first];
+    first = (first + 1) % capacity;
+    numInRing--;
+    return item;
+}
+
+//----------------------------------------------------------------------
+// SynchRing<T>::Append
+//      Append "item" to the end of the ring, waiting while the ring
+//	is full, and wake up anyone waiting for an item.
+//
+//	If there is room and nobody else is in the slow path, nobody
+//	can be waiting either: just store the item.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+SynchRing<T>::Append(T item)
+{
+    if (numSlow == 0 && numInRing < capacity) {
+	Put(item);
+	return;
+    }
+    lock->Acquire();
+    numSlow++;
+    while (numInRing == capacity)
+	ringFull->Wait(lock);		// wait until there is room
+    Put(item);
+    numSlow--;
+    ringEmpty->Signal(lock);		// wake up a waiter, if any
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchRing<T>::TryAppend
+//      Append "item" to the end of the ring if there is room for it.
+//	It never waits for room; but if another thread is in the slow
+//	path, it takes the lock, and so may wait for that thread to
+//	leave it.  Not for use where blocking is not allowed.
+// Returns:
+//	FALSE if the ring was full, and "item" was not added.
+//----------------------------------------------------------------------
+
+template <class T>
+bool
+SynchRing<T>::TryAppend(T item)
+{
+    if (numInRing == capacity)
+	return FALSE;
+    if (numSlow == 0) {
+	Put(item);
+	return TRUE;
+    }
+    lock->Acquire();
+    if (numInRing == capacity) {	// filled up while we waited
+	lock->Release();		// for the lock
+	return FALSE;
+    }
+    Put(item);
+    ringEmpty->Signal(lock);
+    lock->Release();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SynchRing<T>::RemoveFront
+//      Remove the first item from the ring, waiting while the ring is
+//	empty, and wake up anyone waiting for room.
+// Returns:
+//	The removed item.
+//----------------------------------------------------------------------
+
+template <class T>
+T
+SynchRing<T>::RemoveFront()
+{
+    T item;
+
+    if (numSlow == 0 && numInRing > 0)
+	return Take();
+    lock->Acquire();
+    numSlow++;
+    while (numInRing == 0)
+	ringEmpty->Wait(lock);		// wait until there is an item
+    item = Take();
+    numSlow--;
+    ringFull->Signal(lock);		// wake up a waiter, if any
+    lock->Release();
+    return item;
+}
+
+//----------------------------------------------------------------------
+// SynchRing<T>::SelfTest, SelfTestHelper
+//	Test whether the SynchRing implementation is working, by having
+//	two threads ping-pong a value between them using two rings,
+//	the second of them only one item deep, so that both the empty
+//	and the full case have to wait.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+SynchRing<T>::SelfTestHelper (void* data) 
+{
+    SynchRing<T>* _this = (SynchRing<T>*)data;
+    for (int i = 0; i < 20; i++) {
+        _this->Append(_this->selfTestPing->RemoveFront());
+    }
+}
+
+template <class T>
+void
+SynchRing<T>::SelfTest(T val)
+{
+    Thread *helper = new Thread("ping", 1);
+    int i;
+
+    ASSERT(IsEmpty());
+    for (i = 0; i < capacity; i++)	// fill it, and go around once
+	ASSERT(TryAppend(val));
+    ASSERT(!TryAppend(val));
+    for (i = 0; i < capacity; i++)
+	ASSERT(RemoveFront() == val);
+    ASSERT(IsEmpty());
+
+    selfTestPing = new SynchRing<T>(1);
+    helper->Fork(SynchRing<T>::SelfTestHelper, this);
+    for (i = 0; i < 10; i++) {
+        selfTestPing->Append(val);
+        selfTestPing->Append(val);	// waits for the helper
+	ASSERT(val == this->RemoveFront());
+	ASSERT(val == this->RemoveFront());
+    }
+    delete selfTestPing;
+}
@@ -0,0 +1,76 @@
+// synchring.h
+//	Data structures for a bounded, synchronized queue.
+//
+//	Like a SynchList, except that the items are kept in a fixed-size
+//	array used as a circular buffer, so that adding an item
+//	allocates nothing, and that a thread adding an item waits while
+//	the queue is full.
+//
+//	Most of the time a queue is neither empty nor full and no one
+//	is waiting on it; then Append and RemoveFront just store or load
+//	the item, without going through the lock and condition variables.
+//	This is safe because Nachos runs on a single processor, and the
+//	current thread can only lose the CPU where interrupts get
+//	re-enabled (or where it blocks): a few loads and stores with no
+//	call into the synchronization primitives are atomic.  Threads
+//	that have to wait go the slow way, and as long as one of them is
+//	in there, everybody does, so that no wakeup is lost.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation 
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYNCHRING_H
+#define SYNCHRING_H
+
+#include "copyright.h"
+#include "synch.h"
+
+// The following class defines a "synchronized ring" -- a queue of at
+// most "capacity" items, for which these constraints hold:
+//	1. Threads trying to remove an item wait until there is one.
+//	2. Threads trying to add an item wait until there is room.
+//	3. One thread at a time can access the ring.
+
+template <class T>
+class SynchRing {
+  public:
+    SynchRing(int capacity);	// initialize an empty ring
+    ~SynchRing();		// de-allocate the ring
+
+    void Append(T item);	// add item at the end, waiting if the
+				// ring is full
+    bool TryAppend(T item);	// add item at the end, unless the ring
+				// is full; never waits for room, only
+				// (briefly) for the lock
+
+    T RemoveFront();		// remove the first item, waiting if the
+				// ring is empty
+
+    bool IsEmpty() { return numInRing == 0; }
+    int NumInRing() { return numInRing; }
+
+    void SelfTest(T value);	// test the SynchRing implementation
+
+  private:
+    T *items;			// the circular buffer
+    int capacity;		// its size
+    int first;			// index of the first item
+    int numInRing;		// how many items there are
+    int numSlow;		// threads using the lock and conditions;
+				// no fast path while there are any
+    Lock *lock;			// for the threads that may have to wait
+    Condition *ringEmpty;	// wait in RemoveFront if the ring is empty
+    Condition *ringFull;	// wait in Append if the ring is full
+
+    void Put(T item);		// store "item"; there is room
+    T Take();			// load the first item; there is one
+
+    // these are only to assist SelfTest()
+    SynchRing<T> *selfTestPing;
+    static void SelfTestHelper(void* data);
+};
+
+#include "synchring.cc"
+
+#endif // SYNCHRING_H
@@ -49,6 +49,18 @@ Thread::Thread(char* threadName, int threadID)
 
 	/* MP3 */
 	burstTime = 0;
+	startTime = startWaitTime = 0;
+	priority = 0;
+	virtualTime = 0;
+
+    usage = new ThreadUsage(name, ID);
+    kernel->schedMetrics->Register(usage);
+
+    heapIndex = -1;
+    semaphoreWant = 0;
+    waitingFor = NULL;
+    heldLocks = new List<Lock *>;
+    ownPriority = -1;
 }
 
 Thread::Thread(char* threadName, int threadID, int priority)
@@ -68,6 +80,16 @@ Thread::Thread(char* threadName, int threadID, int priority)
 	/* MP3 */
 	burstTime = 0;
 	this->priority = priority;
+	virtualTime = 0;
+
+    usage = new ThreadUsage(name, ID);
+    kernel->schedMetrics->Register(usage);
+
+    heapIndex = -1;
+    semaphoreWant = 0;
+    waitingFor = NULL;
+    heldLocks = new List<Lock *>;
+    ownPriority = -1;
 }
 
 //----------------------------------------------------------------------
@@ -86,8 +108,33 @@ Thread::~Thread()
 {
     DEBUG(dbgThread, "Deleting thread: " << name);
     ASSERT(this != kernel->currentThread);
+    ASSERT(queueLink.list == NULL && agingLink.list == NULL);
+    ASSERT(heapIndex == -1);
     if (stack != NULL)
-	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+	kernel->threadPool->FreeStack(stack);
+    ASSERT(space == NULL);			// given back in Finish
+    kernel->machine->DropRegisters(userRegisters);
+    kernel->threadTable->Remove(this);
+    delete heldLocks;
+}
+
+//----------------------------------------------------------------------
+// Thread::operator new, Thread::operator delete
+// 	Take the room for a Thread object from the thread pool, and
+//	give it back there, so that forking many short-lived threads
+//	does not keep going to the host allocator.
+//----------------------------------------------------------------------
+
+void *
+Thread::operator new(size_t size)
+{
+    return kernel->threadPool->AllocThread(size);
+}
+
+void
+Thread::operator delete(void *thread)
+{
+    kernel->threadPool->FreeThread(thread);
 }
 
 //----------------------------------------------------------------------
@@ -155,6 +202,19 @@ Thread::CheckOverflow()
    }
 }
 
+//----------------------------------------------------------------------
+// Thread::setStatus
+// 	Change the thread's status, and tell the scheduler metrics how
+//	long it had the old one.
+//----------------------------------------------------------------------
+
+void
+Thread::setStatus(ThreadStatus st)
+{
+    kernel->schedMetrics->StatusChanged(this, st);
+    status = st;
+}
+
 //----------------------------------------------------------------------
 // Thread::Begin
 // 	Called by ThreadRoot when a thread is about to begin
@@ -188,16 +248,26 @@ Thread::Begin ()
 //
 // 	NOTE: we disable interrupts, because Sleep() assumes interrupts
 //	are disabled.
+//
+//	The address space is given up here, not in the destructor: if
+//	this is the last thread in it, freeing it takes locks, and the
+//	destructor runs in the next thread, from the scheduler, where
+//	it must not wait.
 //----------------------------------------------------------------------
 
 //
 void
 Thread::Finish ()
 {
-    (void) kernel->interrupt->SetLevel(IntOff);
     ASSERT(this == kernel->currentThread);
+    if (space != NULL && space->Detach())	// last thread in the space:
+	delete space;				// give back its frames and swap
+    space = NULL;
+
+    (void) kernel->interrupt->SetLevel(IntOff);
 
     DEBUG(dbgThread, "Finishing thread: " << name);
+    kernel->schedMetrics->Exited(this);
     Sleep(TRUE);				// invokes SWITCH
     // not reached
 }
@@ -232,12 +302,7 @@ Thread::Yield ()
     DEBUG(dbgThread, "Yielding thread: " << name);
 
 	/* SJF  */
-	if(this->getPriority() >= 100)
-	{
-		double actBurst = kernel->stats->userTicks - this->getStartTime();
-		double estBurst = 0.5 * actBurst + 0.5 * this->getBurstTime();
-		this->setBurstTime(estBurst);
-	}
+	kernel->scheduler->Stopped(this);
 
 	  nextThread = kernel->scheduler->FindNextToRun();
     if (nextThread != NULL) {
@@ -278,16 +343,11 @@ Thread::Sleep (bool finishing)
 
     DEBUG(dbgThread, "Sleeping thread: " << name);
 
-    status = BLOCKED;
+    setStatus(BLOCKED);
 
 	/* MP3 Sleep */
 	/* SJF ? */
-	if(this->getPriority() >= 100)
-	{
-		double actBurst = kernel->stats->userTicks - this->getStartTime();
-		double estBurst = 0.5 * actBurst + 0.5 * this->getBurstTime();
-		this->setBurstTime(estBurst);
-	}
+	kernel->scheduler->Stopped(this);
 
 	//cout << "debug Thread::Sleep " << name << "wait for Idle\n";
     while ((nextThread = kernel->scheduler->FindNextToRun()) == NULL) {
@@ -348,7 +408,7 @@ PLabelToAddr(void *plabel)
 void
 Thread::StackAllocate (VoidFunctionPtr func, void *arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = kernel->threadPool->AllocStack();
 
 #ifdef PARISC
     // HP stack works from low addresses to high addresses
@@ -406,36 +466,22 @@ Thread::StackAllocate (VoidFunctionPtr func, void *arg)
 
 #include "machine.h"
 
-//----------------------------------------------------------------------
-// Thread::SaveUserState
-//	Save the CPU state of a user program on a context switch.
-//
-//	Note that a user program thread has *two* sets of CPU registers --
-//	one for its state while executing user code, one for its state
-//	while executing kernel code.  This routine saves the former.
-//----------------------------------------------------------------------
-
-void
-Thread::SaveUserState()
-{
-    for (int i = 0; i < NumTotalRegs; i++)
-	userRegisters[i] = kernel->machine->ReadRegister(i);
-}
-
 //----------------------------------------------------------------------
 // Thread::RestoreUserState
-//	Restore the CPU state of a user program on a context switch.
+//	Give the CPU the user program state of this thread, on a context
+//	switch or when the thread starts running a program.
 //
 //	Note that a user program thread has *two* sets of CPU registers --
 //	one for its state while executing user code, one for its state
 //	while executing kernel code.  This routine restores the former.
+//	The simulated CPU works on userRegisters directly, so that there
+//	is nothing to copy, and nothing to save when the thread stops.
 //----------------------------------------------------------------------
 
 void
 Thread::RestoreUserState()
 {
-    for (int i = 0; i < NumTotalRegs; i++)
-	kernel->machine->WriteRegister(i, userRegisters[i]);
+    kernel->machine->UseRegisters(userRegisters);
 }
 
 
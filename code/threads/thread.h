@@ -42,6 +42,8 @@
 #include "sysdep.h"
 #include "machine.h"
 #include "addrspace.h"
+#include "list.h"
+#include "ilist.h"
 
 // CPU register state to be saved on context switch.
 // The x86 needs to save only a few registers,
@@ -73,6 +75,9 @@ enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED, ZOMBIE };
 //  Some threads also belong to a user address space; threads
 //  that only run in the kernel have a NULL address space.
 
+class ThreadUsage;
+class Lock;
+
 class Thread {
   private:
     // NOTE: DO NOT CHANGE the order of these first two members.
@@ -85,7 +90,7 @@ class Thread {
     int startTime;
     int priority;
     int startWaitTime;
-
+    double virtualTime;		// CFS virtual runtime, or stride pass
 
   public:
 
@@ -94,11 +99,13 @@ class Thread {
     double getBurstTime(){ return burstTime; }
     int getPriority(){ return priority; }
     int getStartWaitTime() { return startWaitTime; }
+    double getVirtualTime() { return virtualTime; }
 
     void setStartTime(int s){ startTime = s; }
     void setBurstTime(double s){ burstTime = s; }
     void setPriority(int s){ priority = s; }
     void setStartWaitTime(int s){ startWaitTime = s; }
+    void setVirtualTime(double v) { virtualTime = v; }
 
     Thread(char* debugName, int threadID);		// initialize a Thread
     Thread(char* threadName, int threadID, int priority);
@@ -108,6 +115,9 @@ class Thread {
 					// must not be running when delete
 					// is called
 
+    void *operator new(size_t size);	// Thread objects are recycled
+    void operator delete(void *thread);	// by kernel->threadPool
+
     // basic thread operations
 
     void Fork(VoidFunctionPtr func, void *arg);
@@ -120,7 +130,7 @@ class Thread {
     void Finish();  		// The thread is done executing
 
     void CheckOverflow();   	// Check if thread stack has overflowed
-    void setStatus(ThreadStatus st) { status = st; }
+    void setStatus(ThreadStatus st);
     ThreadStatus getStatus() { return (status); }
 	char* getName() { return (name); }
 
@@ -148,12 +158,34 @@ class Thread {
     int userRegisters[NumTotalRegs];	// user-level CPU register state
 
   public:
-    void SaveUserState();		// save user-level register state
-    void RestoreUserState();		// restore user-level register state
+    void RestoreUserState();		// hand user-level register state to
+					// the CPU
 
     AddrSpace *space;			// User code this thread is running.
+    ThreadUsage *usage;			// time spent in each state
+
+    // Links for the queues a thread goes on, so that going on and off
+    // them allocates nothing (see ilist.h)
+    ListLink<Thread> queueLink;		// ready queue, or the queue of the
+					// semaphore, lock or condition it
+					// waits on -- one at a time
+    ListLink<Thread> agingLink;		// MLFQ aging list, while ready
+    int heapIndex;			// where it is in a ThreadHeap (see
+					// readyqueue.h), -1 if in none
+    int semaphoreWant;			// how much it waits for in P(n)
+
+    // Priority inheritance, kept up to date by class Lock
+    Lock *waitingFor;			// lock this thread is blocked on
+    List<Lock *> *heldLocks;		// locks this thread holds
+    int ownPriority;			// priority before it was donated
+					// a higher one; -1 if it was not
 };
 
+// A queue of threads, linked through queueLink: ready queues and wait
+// queues.
+typedef IntrusiveList<Thread, &Thread::queueLink> ThreadQueue;
+typedef IntrusiveListIterator<Thread, &Thread::queueLink> ThreadQueueIterator;
+
 // external function, dummy routine whose sole job is to call Thread::Print
 extern void ThreadPrint(Thread *thread);
 
@@ -0,0 +1,123 @@
+// threadpool.cc
+//	Routines to recycle thread stacks and Thread objects.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "threadpool.h"
+#include "thread.h"
+#include "sysdep.h"
+#include <iostream>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// ThreadPool::ThreadPool
+// 	Initialize an empty pool.
+//
+//	"maxFree" is how many free stacks (and Thread objects) to keep
+//----------------------------------------------------------------------
+
+ThreadPool::ThreadPool(int maxFree)
+{
+    cap = maxFree;
+    stacks = new List<int *>;
+    threads = new List<void *>;
+    stacksAllocated = stacksReused = 0;
+    threadsAllocated = threadsReused = 0;
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::~ThreadPool
+// 	Give back everything on the free lists.
+//----------------------------------------------------------------------
+
+ThreadPool::~ThreadPool()
+{
+    while (!stacks->IsEmpty())
+	DeallocBoundedArray((char *) stacks->RemoveFront(),
+				StackSize * sizeof(int));
+    while (!threads->IsEmpty())
+	::operator delete(threads->RemoveFront());
+    delete stacks;
+    delete threads;
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::AllocStack
+// 	Return a stack of StackSize words, with its guard pages.  Take
+//	one off the free list if there is one.
+//----------------------------------------------------------------------
+
+int *
+ThreadPool::AllocStack()
+{
+    if (!stacks->IsEmpty()) {
+	stacksReused++;
+	return stacks->RemoveFront();
+    }
+    stacksAllocated++;
+    return (int *) AllocBoundedArray(StackSize * sizeof(int));
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::FreeStack
+// 	Keep "stack" for the next thread, unless we have enough.
+//----------------------------------------------------------------------
+
+void
+ThreadPool::FreeStack(int *stack)
+{
+    if ((int) stacks->NumInList() < cap)
+	stacks->Prepend(stack);		// still warm in the host's cache
+    else
+	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::AllocThread
+// 	Return room for a Thread object, "size" bytes.
+//----------------------------------------------------------------------
+
+void *
+ThreadPool::AllocThread(size_t size)
+{
+    ASSERT(size == sizeof(Thread));
+    if (!threads->IsEmpty()) {
+	threadsReused++;
+	return threads->RemoveFront();
+    }
+    threadsAllocated++;
+    return ::operator new(size);
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::FreeThread
+// 	Keep the room of a destroyed Thread object, unless we have
+//	enough.
+//----------------------------------------------------------------------
+
+void
+ThreadPool::FreeThread(void *thread)
+{
+    if ((int) threads->NumInList() < cap)
+	threads->Prepend(thread);
+    else
+	::operator delete(thread);
+}
+
+//----------------------------------------------------------------------
+// ThreadPool::Print
+// 	Print how many stacks and Thread objects had to be allocated,
+//	and how many were reused.
+//----------------------------------------------------------------------
+
+void
+ThreadPool::Print()
+{
+    cout << "Thread pool: stacks " << stacksAllocated << " allocated, "
+	<< stacksReused << " reused; threads " << threadsAllocated
+	<< " allocated, " << threadsReused << " reused\n";
+}
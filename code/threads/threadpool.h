@@ -0,0 +1,51 @@
+// threadpool.h
+//	Data structures for recycling thread stacks and Thread objects.
+//
+//	A thread stack is allocated with two guard pages around it
+//	(AllocBoundedArray), which costs a couple of mprotect system
+//	calls on the host each time; so does freeing it again.  When
+//	many short-lived threads are forked, that is most of the time
+//	the simulation takes.  Instead, stacks and the Thread objects
+//	themselves are kept on free lists when the thread is destroyed,
+//	and handed out again to the next thread forked, guard pages and
+//	all.  At most "cap" of each are kept; beyond that, they are
+//	really freed.  A cap of 0 turns the pool off.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "copyright.h"
+#include "list.h"
+
+// How many free stacks and Thread objects are kept, by default
+const int ThreadPoolSize = 16;
+
+// The following class defines the pool.
+
+class ThreadPool {
+  public:
+    ThreadPool(int maxFree);	// Keep at most "maxFree" of each
+    ~ThreadPool();		// Really free whatever is kept
+
+    int *AllocStack();		// Return a guarded thread stack
+    void FreeStack(int *stack);	// Done with it
+    void *AllocThread(size_t size);
+    				// Return room for a Thread object
+    void FreeThread(void *thread);
+    				// Done with it
+
+    void Print();		// How often the pool was used
+
+  private:
+    int cap;
+    List<int *> *stacks;	// free stacks
+    List<void *> *threads;	// free room for Thread objects
+    int stacksAllocated, stacksReused;
+    int threadsAllocated, threadsReused;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,187 @@
+// threadtable.cc
+//	Routines to keep track of threads by ID.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "threadtable.h"
+#include "thread.h"
+#include "main.h"
+
+// Initial number of entries; doubled whenever it runs out.
+const int ThreadTableSize = 16;
+
+//----------------------------------------------------------------------
+// ThreadTable::ThreadTable
+// 	Initialize an empty table.
+//----------------------------------------------------------------------
+
+ThreadTable::ThreadTable()
+{
+    size = ThreadTableSize;
+    table = new ThreadEntry[size];
+    for (int i = 0; i < size; i++) {
+	table[i].thread = NULL;
+	table[i].done = FALSE;
+	table[i].joiners = new List<Thread *>;
+    }
+    nextID = FirstThreadID;
+    freeIDs = new List<int>;
+    numThreads = 0;
+}
+
+//----------------------------------------------------------------------
+// ThreadTable::~ThreadTable
+// 	De-allocate the table; the threads are not touched.
+//----------------------------------------------------------------------
+
+ThreadTable::~ThreadTable()
+{
+    for (int i = 0; i < size; i++)
+	delete table[i].joiners;
+    delete [] table;
+    delete freeIDs;
+}
+
+//----------------------------------------------------------------------
+// ThreadTable::Allocate
+// 	Return an ID no thread in the table has: the one freed longest
+//	ago, or else a new one.
+//----------------------------------------------------------------------
+
+int
+ThreadTable::Allocate()
+{
+    if (!freeIDs->IsEmpty())
+	return freeIDs->RemoveFront();
+    return nextID++;
+}
+
+//----------------------------------------------------------------------
+// ThreadTable::Enter
+// 	Put "thread" in the table under its ID, making the table larger
+//	if the ID does not fit.
+//----------------------------------------------------------------------
+
+void
+ThreadTable::Enter(Thread *thread)
+{
+    int id = thread->getID();
+    ThreadEntry *old;
+    int oldSize;
+
+    ASSERT(id >= FirstThreadID);
+    if (id >= size) {
+	old = table;
+	oldSize = size;
+	while (size <= id)
+	    size *= 2;
+	table = new ThreadEntry[size];
+	for (int i = 0; i < size; i++) {
+	    if (i < oldSize) {
+		table[i] = old[i];
+	    } else {
+		table[i].thread = NULL;
+		table[i].done = FALSE;
+		table[i].joiners = new List<Thread *>;
+	    }
+	}
+	delete [] old;
+    }
+    ASSERT(table[id].thread == NULL && table[id].joiners->IsEmpty());
+    table[id].thread = thread;
+    table[id].done = FALSE;		// forget the last thread with this ID
+    numThreads++;
+}
+
+//----------------------------------------------------------------------
+// ThreadTable::Remove
+// 	Take "thread" out of the table, and let its ID be used again.
+//	A thread that goes away without calling Exit (it was killed,
+//	or its program could not be loaded) ends with status -1.
+//----------------------------------------------------------------------
+
+void
+ThreadTable::Remove(Thread *thread)
+{
+    int id = thread->getID();
+
+    if (id < FirstThreadID || id >= size || table[id].thread != thread)
+	return;				// not one of ours
+    if (!table[id].done)
+	Exit(thread, -1);
+    table[id].thread = NULL;
+    freeIDs->Append(id);
+    numThreads--;
+}
+
+//----------------------------------------------------------------------
+// ThreadTable::Lookup
+// 	Return the thread with ID "id", or NULL if there is none.
+//----------------------------------------------------------------------
+
+Thread *
+ThreadTable::Lookup(int id)
+{
+    if (id < 0 || id >= size)
+	return NULL;
+    return table[id].thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadTable::Exit
+// 	Record that "thread" is done, with exit status "status", and
+//	wake up the threads waiting for it.  Does nothing if "thread"
+//	is not in the table.
+//----------------------------------------------------------------------
+
+void
+ThreadTable::Exit(Thread *thread, int status)
+{
+    int id = thread->getID();
+    IntStatus oldLevel;
+
+    if (id < FirstThreadID || id >= size || table[id].thread != thread)
+	return;
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    table[id].done = TRUE;
+    table[id].exitStatus = status;
+    while (!table[id].joiners->IsEmpty())
+	kernel->scheduler->ReadyToRun(table[id].joiners->RemoveFront());
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// ThreadTable::Join
+// 	Wait until the thread with ID "id" is done, and return its exit
+//	status.  The caller sleeps until then; it is woken up by Exit,
+//	so no time is spent polling.  Returns -1 right away if no
+//	thread with "id" was ever entered (or the ID was handed out
+//	again since), or if a thread tries to wait for itself.
+//----------------------------------------------------------------------
+
+int
+ThreadTable::Join(int id)
+{
+    Thread *current = kernel->currentThread;
+    IntStatus oldLevel;
+    int status;
+
+    if (id < FirstThreadID || id >= size)
+	return -1;
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    if (table[id].thread == current
+		|| (table[id].thread == NULL && !table[id].done)) {
+	(void) kernel->interrupt->SetLevel(oldLevel);
+	return -1;
+    }
+    while (!table[id].done) {
+	table[id].joiners->Append(current);
+	current->Sleep(FALSE);
+    }
+    status = table[id].exitStatus;
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    return status;
+}
@@ -0,0 +1,70 @@
+// threadtable.h
+//	Data structures for finding a thread by its ID.
+//
+//	Threads that run user programs are entered in a table indexed
+//	by thread ID, which grows as needed, so that there is no limit
+//	on the number of programs and a lookup takes O(1).  The ID of
+//	a thread that is destroyed is handed out again -- after every
+//	ID freed before it, so that a recycled ID is not mistaken for
+//	a thread that just went away.
+//
+//	The table also remembers how each thread ended, so that other
+//	threads can wait for it (Join).  The exit status stays around
+//	after the thread is destroyed, until its ID is handed out again.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef THREADTABLE_H
+#define THREADTABLE_H
+
+#include "copyright.h"
+#include "list.h"
+
+class Thread;
+
+// IDs below this one are not handed out: 0 is the main thread, 1 the
+// kernel's own helper threads (the pager, the postal worker).
+const int FirstThreadID = 2;
+
+// The following class defines one slot of the table.
+
+class ThreadEntry {
+  public:
+    Thread *thread;		// NULL once it is destroyed
+    bool done;			// has it exited?
+    int exitStatus;		// if so, its exit status
+    List<Thread *> *joiners;	// threads waiting for it to exit
+};
+
+// The following class defines the table.
+
+class ThreadTable {
+  public:
+    ThreadTable();		// Initialize an empty table
+    ~ThreadTable();
+
+    int Allocate();		// Reserve an ID that is not in use
+    void Enter(Thread *thread);	// Enter "thread" under its ID, which
+				// came from Allocate
+    void Remove(Thread *thread);// "thread" is going away; free its ID.
+				// Does nothing if it is not in the table
+    Thread *Lookup(int id);	// The thread with "id", NULL if none
+    int NumInTable() { return numThreads; }
+
+    void Exit(Thread *thread, int status);
+				// "thread" is done, with "status"
+    int Join(int id);		// Wait until the thread with "id" is
+				// done; return its exit status, -1 if
+				// there is no such thread
+
+  private:
+    ThreadEntry *table;		// indexed by ID
+    int size;			// entries allocated in "table"
+    int nextID;			// lowest ID never handed out
+    List<int> *freeIDs;		// IDs to hand out again, oldest first
+    int numThreads;
+};
+
+#endif // THREADTABLE_H
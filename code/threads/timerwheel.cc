@@ -0,0 +1,153 @@
+// timerwheel.cc
+//	Routines for the hierarchical timer wheel of sleeping threads.
+//
+//	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "timerwheel.h"
+
+// Index of the slot of tick "t" at "level".
+#define SlotOf(t, level)	(((t) >> ((level) * WheelBits)) & (WheelSlots - 1))
+
+//----------------------------------------------------------------------
+// TimerWheel::TimerWheel
+// 	Initialize an empty wheel.
+//
+//	"now" is the current time, in ticks
+//----------------------------------------------------------------------
+
+TimerWheel::TimerWheel(int now)
+{
+    for (int l = 0; l < WheelLevels; l++)
+	for (int s = 0; s < WheelSlots; s++)
+	    slots[l][s] = new List<WheelEntry *>;
+    current = now;
+    numEntries = 0;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::~TimerWheel
+// 	De-allocate the wheel.  The sleeping threads are not touched.
+//----------------------------------------------------------------------
+
+TimerWheel::~TimerWheel()
+{
+    for (int l = 0; l < WheelLevels; l++)
+	for (int s = 0; s < WheelSlots; s++) {
+	    while (!slots[l][s]->IsEmpty())
+		delete slots[l][s]->RemoveFront();
+	    delete slots[l][s];
+	}
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Place
+// 	Put "entry" in the slot of the lowest level that still reaches
+//	its deadline.  A deadline already passed goes in the next slot
+//	to be processed; one beyond the last level goes as far as the
+//	last level reaches, and is placed again from there.
+//----------------------------------------------------------------------
+
+void
+TimerWheel::Place(WheelEntry *entry)
+{
+    int delta = entry->when - current;
+    int when = entry->when;
+    int level;
+
+    if (delta < 0) {
+	when = current;
+	delta = 0;
+    }
+    for (level = 0; level < WheelLevels - 1; level++) {
+	if (delta < (1 << ((level + 1) * WheelBits)))
+	    break;
+    }
+    if (delta >= (1 << (WheelLevels * WheelBits)))
+	when = current + (1 << (WheelLevels * WheelBits)) - 1;
+    slots[level][SlotOf(when, level)]->Append(entry);
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Insert
+// 	Put "thread" to sleep until tick "when".
+//----------------------------------------------------------------------
+
+void
+TimerWheel::Insert(Thread *thread, int when)
+{
+    WheelEntry *entry = new WheelEntry;
+
+    entry->thread = thread;
+    entry->when = when;
+    Place(entry);
+    numEntries++;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Cascade
+// 	Take every entry out of the current slot of "level", and place
+//	it again; now that time has come closer, it lands on a lower
+//	level.  Returns the index of the slot, so that the caller knows
+//	whether this level wrapped around too.
+//----------------------------------------------------------------------
+
+int
+TimerWheel::Cascade(int level)
+{
+    int index = SlotOf(current, level);
+    List<WheelEntry *> *slot = slots[level][index];
+    List<WheelEntry *> moving;
+
+    while (!slot->IsEmpty())
+	moving.Append(slot->RemoveFront());
+    while (!moving.IsEmpty())
+	Place(moving.RemoveFront());
+    return index;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Advance
+// 	Process every tick up to and including "now".  Threads whose
+//	deadline has come are taken off the wheel and appended to
+//	"expired", in deadline order.
+//----------------------------------------------------------------------
+
+void
+TimerWheel::Advance(int now, List<Thread *> *expired)
+{
+    List<WheelEntry *> due;
+    WheelEntry *entry;
+    int index;
+
+    while (current <= now) {
+	if (numEntries == 0) {		// nothing to do, jump ahead
+	    current = now + 1;
+	    break;
+	}
+	index = SlotOf(current, 0);
+	if (index == 0) {		// level 0 wrapped; refill it
+	    for (int l = 1; l < WheelLevels; l++) {
+		if (Cascade(l) != 0)
+		    break;
+	    }
+	}
+	current++;
+	while (!slots[0][index]->IsEmpty())
+	    due.Append(slots[0][index]->RemoveFront());
+	while (!due.IsEmpty()) {
+	    entry = due.RemoveFront();
+	    if (entry->when >= current) {	// went around; not yet
+		Place(entry);
+		continue;
+	    }
+	    expired->Append(entry->thread);
+	    delete entry;
+	    numEntries--;
+	}
+    }
+}
@@ -0,0 +1,67 @@
+// timerwheel.h
+//	Data structures for the queue of sleeping threads.
+//
+//	A hierarchical timer wheel: WheelLevels wheels of WheelSlots
+//	slots each.  Level 0 has one slot per tick for the next
+//	WheelSlots ticks, level 1 one slot per WheelSlots ticks, and so
+//	on.  A sleeper goes into the slot of the coarsest level its
+//	deadline needs, in O(1).  As time passes, the slots of level 0
+//	are emptied in turn, and every time level 0 wraps around, the
+//	next slot of level 1 is spread out over level 0 ("cascaded"),
+//	and so on up.  Each sleeper is moved at most WheelLevels times,
+//	so waking the due sleepers costs in proportion to their number,
+//	not to the number of sleepers.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include "copyright.h"
+#include "list.h"
+
+class Thread;
+
+const int WheelBits = 6;
+const int WheelSlots = 1 << WheelBits;	// slots per level
+const int WheelLevels = 4;		// covers 2^24 ticks; sleeps longer
+					// than that go around more than once
+
+// The following class defines one sleeper.
+
+class WheelEntry {
+  public:
+    Thread *thread;
+    int when;			// tick to wake up at
+};
+
+// The following class defines the wheel.
+
+class TimerWheel {
+  public:
+    TimerWheel(int now);	// Initialize an empty wheel; time starts
+				// at tick "now"
+    ~TimerWheel();
+
+    void Insert(Thread *thread, int when);
+				// "thread" sleeps until tick "when"
+    void Advance(int now, List<Thread *> *expired);
+				// Move time up to "now", appending every
+				// thread that is due to "expired"
+    bool IsEmpty() { return numEntries == 0; }
+    int NumInList() { return numEntries; }
+
+  private:
+    List<WheelEntry *> *slots[WheelLevels][WheelSlots];
+    int current;		// next tick to process
+    int numEntries;
+
+    void Place(WheelEntry *entry);
+				// Put "entry" in the slot for its deadline
+    int Cascade(int level);	// Spread the current slot of "level" over
+				// the levels below; return its index
+};
+
+#endif // TIMERWHEEL_H
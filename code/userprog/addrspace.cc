@@ -20,7 +20,14 @@
 #include "main.h"
 #include "addrspace.h"
 #include "machine.h"
-#include "noff.h"
+#include "frametable.h"
+#include "textcache.h"
+#include "synchdisk.h"
+
+// The TLB holds translations of one address space at a time, the one
+// last switched to; entries are replaced round robin.
+static AddrSpace *tlbSpace = NULL;
+static int tlbNext = 0;
 
 //----------------------------------------------------------------------
 // SwapHeader
@@ -61,47 +68,80 @@ SwapHeader (NoffHeader *noffH)
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
-//	Set up the translation from program memory to physical
-//	memory.  For now, this is really simple (1:1), since we are
-//	only uniprogramming, and we have a single unsegmented page table
+//	Nothing is mapped until the program is loaded; after that,
+//	pages are brought into memory on demand (see PageFault).
 //----------------------------------------------------------------------
 
 AddrSpace::AddrSpace()
 {
-    // pageTable = new TranslationEntry[NumPhysPages];
-    // for (int i = 0; i < NumPhysPages; i++) {
-	// pageTable[i].virtualPage = i;	// for now, virt page # = phys page #
-	// pageTable[i].physicalPage = i;
-	// pageTable[i].valid = FALSE;
-	// pageTable[i].use = FALSE;
-	// pageTable[i].dirty = FALSE;
-	// pageTable[i].readOnly = FALSE;
-    // }
-    //
-    // // zero out the entire address space
-    // bzero(kernel->machine->mainMemory, MemorySize);
+    pageTable = NULL;
+    numPages = 0;
+    image = NULL;
+    numThreads = 1;
+    swapSector = NULL;
+    lastUse = NULL;
+    numResident = 0;
+    usage = NULL;
+    runStart = 0;
+    prefetched = NULL;
+    prefetchWindow = 1;
+    nextSequential = -1;
 }
 
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.
+// 	Dealloate an address space.  Give back its frames and swap
+//	sectors, and leave the paging statistics behind for the
+//	report printed at halt.
+//
+//	This takes the VM lock and the text cache's lock, so it must
+//	run in a thread that may wait (see Thread::Finish).
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace()
 {
-    for(int i=0 ; i<numPages ; i++)
-        if(pageTable[i].valid)
-            kernel->freeFrameList->Append(pageTable[i].physicalPage);
-    delete pageTable;
-}
+    FrameTable *frameTable = kernel->frameTable;
+    int frame;
 
+    frameTable->vmLock->Acquire();	// the pager may be at our frames
+    for (int i = 0; i < numPages; i++) {
+	if (pageTable[i].valid)
+	    CountPrefetch(i);
+	frame = pageTable[i].physicalPage;
+	if (swapSector[i] >= 0 &&
+		!(frame >= 0 && frameTable->PagingOut(this, i, frame)))
+	    frameTable->FreeSwap(swapSector[i]);  // else the pager will
+    }
+    frameTable->ReleaseSpace(this);
+    kernel->scheduler->ForgetSpace(this);
+    if (tlbSpace == this) {		// its translations are gone
+	for (int i = 0; i < TLBSize; i++)
+	    kernel->machine->tlb[i].valid = FALSE;
+	tlbSpace = NULL;
+    }
+    if (usage != NULL) {
+        usage->workingSet = WorkingSetSize();
+        usage->resident = 0;
+        usage->space = NULL;
+    }
+    frameTable->vmLock->Release();
+    delete [] pageTable;
+    delete [] swapSector;
+    delete [] lastUse;
+    delete [] prefetched;
+    if (image != NULL)
+	kernel->textCache->Put(image);
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::Load
-// 	Load a user program into memory from a file.
+// 	Prepare to run a user program from a file.
 //
-//	Assumes that the page table has been initialized, and that
-//	the object code file is in NOFF format.
+//	Assumes that the object code file is in NOFF format.
+//	Only the header is looked at here; code and data pages are
+//	copied from the image of the file in the text cache when first
+//	touched, so the file is read from disk only once no matter how
+//	many programs run it.
 //
 //	"fileName" is the file containing the object code to load into memory
 //----------------------------------------------------------------------
@@ -109,16 +149,15 @@ AddrSpace::~AddrSpace()
 bool
 AddrSpace::Load(char *fileName)
 {
-    OpenFile *executable = kernel->fileSystem->Open(fileName);
-    NoffHeader noffH;
     unsigned int size;
 
-    if (executable == NULL) {
+    image = kernel->textCache->Get(fileName);
+    if (image == NULL) {
 	cerr << "Unable to open file " << fileName << "\n";
 	return FALSE;
     }
 
-    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
+    image->ReadAt((char *)&noffH, sizeof(noffH), 0);
     if ((noffH.noffMagic != NOFFMAGIC) &&
 		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
     	SwapHeader(&noffH);
@@ -139,66 +178,605 @@ AddrSpace::Load(char *fileName)
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
 
-    ASSERT(numPages <= kernel->freeFrameList->NumInList());		// check we're not trying
-						// to run anything too big --
-						// at least until we have
-						// virtual memory
+    ASSERT(numPages <= NumSwapSectors);	// every page must fit in swap
 
     DEBUG(dbgAddr, "Initializing address space: " << numPages << ", " << size);
 
     pageTable = new TranslationEntry[numPages];
-    for (int i = 0; i < numPages ; i++) {
-    int freeFrame = kernel->freeFrameList->Front();
-    kernel->freeFrameList->RemoveFront();
-    pageTable[i].virtualPage = i;	// for now, virt page # = phys page #
-    pageTable[i].physicalPage = freeFrame;
-    pageTable[i].valid = TRUE;
-    pageTable[i].use = FALSE;
-    pageTable[i].dirty = FALSE;
-    pageTable[i].readOnly = FALSE;
-    // zero out
-    //bzero((void*)(kernel->machine->mainMemory[freeFrame*PageSize]), PageSize);
+    swapSector = new int[numPages];
+    lastUse = new int[numPages];
+    prefetched = new bool[numPages];
+    for (int i = 0; i < numPages; i++) {
+	pageTable[i].virtualPage = i;
+	pageTable[i].physicalPage = -1;
+	pageTable[i].valid = FALSE;	// not in memory yet
+	pageTable[i].use = FALSE;
+	pageTable[i].dirty = FALSE;
+	pageTable[i].readOnly = FALSE;
+	pageTable[i].large = FALSE;
+	swapSector[i] = -1;
+	prefetched[i] = FALSE;
+	lastUse[i] = -kernel->frameTable->Window() - 1;
     }
 
+    usage = new VMUsage(fileName, kernel->currentThread->getID());
+    usage->space = this;
+    kernel->frameTable->Register(usage);
+
+    if (kernel->frameTable->LargePages())
+	MapLargePages();
+
+    return TRUE;			// success
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadSegment
+// 	Copy the part of segment "seg" that overlaps virtual page "vpn"
+//	from the executable into "into" (the start of the page frame).
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadSegment(Segment *seg, int vpn, char *into)
+{
+    int pageStart = vpn * PageSize;
+    int start = max(seg->virtualAddr, pageStart);
+    int end = min(seg->virtualAddr + seg->size, pageStart + PageSize);
 
+    if (seg->size <= 0 || start >= end)
+	return;
+    image->ReadAt(into + (start - pageStart), end - start,
+			seg->inFileAddr + (start - seg->virtualAddr));
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MapLargePages
+// 	Map every naturally aligned region of LargePagePages pages with
+//	a single large page, as long as the frame table can spare an
+//	aligned run of frames for it.  The regions are loaded right
+//	away and stay in memory; the rest of the space is demand paged
+//	as usual.  A big array then takes one TLB entry (and one page
+//	table lookup) per region instead of one per page.
+//----------------------------------------------------------------------
 
-// then, copy in the code and data segments into memory
-// Note: this code assumes that virtual address = physical address
-    if (noffH.code.size > 0) {
-        DEBUG(dbgAddr, "Initializing code segment.");
-	    DEBUG(dbgAddr, noffH.code.virtualAddr << ", " << noffH.code.size);
+void
+AddrSpace::MapLargePages()
+{
+    FrameTable *frameTable = kernel->frameTable;
+    unsigned int vpn;
+    int frame;
+    char *into;
 
-        unsigned int paddr;
-        AddrSpace::Translate( noffH.code.virtualAddr, &paddr, 0);
+    frameTable->vmLock->Acquire();
+    for (vpn = 0; vpn + LargePagePages <= numPages; vpn += LargePagePages) {
+	frame = frameTable->AllocateLarge(this, vpn);
+	if (frame < 0)
+	    break;
+	DEBUG(dbgAddr, "Large page at " << vpn << ", frames " << frame);
 
-        executable->ReadAt(
-		&(kernel->machine->mainMemory[paddr]),
-			noffH.code.size, noffH.code.inFileAddr);
+	into = &(kernel->machine->mainMemory[frame * PageSize]);
+	bzero(into, LargePagePages * PageSize);
+	for (int i = 0; i < LargePagePages; i++) {
+	    LoadSegment(&noffH.code, vpn + i, into + i * PageSize);
+	    LoadSegment(&noffH.initData, vpn + i, into + i * PageSize);
+#ifdef RDATA
+	    LoadSegment(&noffH.readonlyData, vpn + i, into + i * PageSize);
+#endif
+	    MapPage(vpn + i, frame + i);
+	}
+	pageTable[vpn].large = TRUE;
+	kernel->stats->numLargePages++;
     }
-    if (noffH.initData.size > 0) {
-        DEBUG(dbgAddr, "Initializing data segment.");
-	    DEBUG(dbgAddr, noffH.initData.virtualAddr << ", " << noffH.initData.size);
+    frameTable->vmLock->Release();
+}
 
-        unsigned int paddr;
-        AddrSpace::Translate( noffH.code.virtualAddr, &paddr, 0);
+//----------------------------------------------------------------------
+// AddrSpace::PageFault
+// 	Bring the page containing "vaddr" into memory.  If the frame
+//	it was last in is still in the free pool, just take it back.
+//	Otherwise the contents come from the swap area if the page was
+//	written back before, else from the executable (code and data)
+//	or zero (bss and stack).  In the last case the pages after it
+//	may be read ahead as well, see Prefetch.
+//
+//	Returns FALSE if "vaddr" is not part of the address space, or
+//	if no frame can be had because memory and swap are both full.
+//----------------------------------------------------------------------
 
-        executable->ReadAt(
-		&(kernel->machine->mainMemory[paddr]),
-			noffH.initData.size, noffH.initData.inFileAddr);
+bool
+AddrSpace::PageFault(unsigned int vaddr)
+{
+    FrameTable *frameTable = kernel->frameTable;
+    unsigned int vpn = vaddr / PageSize;
+    TranslationEntry *pte;
+    int frame;
+    char *into;
+
+    frameTable->vmLock->Acquire();
+    // Another thread of this program may replace the page table (see
+    // AddStack) whenever we wait, so look up our entry again each time.
+    for (;;) {
+	if (vpn >= numPages) {
+	    frameTable->vmLock->Release();
+	    return FALSE;
+	}
+	pte = &pageTable[vpn];
+	if (pte->valid || pte->physicalPage < 0
+		|| !frameTable->PagingOut(this, vpn, pte->physicalPage))
+	    break;
+	frameTable->WaitForPager();	// let the write finish first
+    }
+    if (pte->valid) {			// just a TLB miss, or someone
+	if (kernel->machine->tlb != NULL)	// else brought it in while
+	    LoadTLB(vpn);		// we were waiting
+	frameTable->vmLock->Release();
+	return TRUE;
     }
 
+    kernel->stats->numPageFaults++;
+    usage->faults++;
+
+    frame = pte->physicalPage;
+    if (frame >= 0 && frameTable->Reclaim(this, vpn, frame)) {
+	kernel->stats->numPageReclaims++;
+	DEBUG(dbgAddr, "Reclaimed page " << vpn << " in frame " << frame);
+	MapPage(vpn, frame);
+    } else {
+	frame = frameTable->Allocate(this, vpn);
+	if (frame < 0) {
+	    frameTable->vmLock->Release();
+	    cerr << "Out of swap space\n";
+	    return FALSE;
+	}
+	into = &(kernel->machine->mainMemory[frame * PageSize]);
+	DEBUG(dbgAddr, "Page fault on " << vpn << ", using frame " << frame);
+
+	if (swapSector[vpn] >= 0) {
+	    kernel->synchDisk->ReadSector(swapSector[vpn], into);
+	    MapPage(vpn, frame);
+	} else {
+	    bzero(into, PageSize);
+	    LoadSegment(&noffH.code, vpn, into);
+	    LoadSegment(&noffH.initData, vpn, into);
 #ifdef RDATA
-    if (noffH.readonlyData.size > 0) {
-        DEBUG(dbgAddr, "Initializing read only data segment.");
-	    DEBUG(dbgAddr, noffH.readonlyData.virtualAddr << ", " << noffH.readonlyData.size);
-        executable->ReadAt(
-		&(kernel->machine->mainMemory[noffH.readonlyData.virtualAddr]),
-			noffH.readonlyData.size, noffH.readonlyData.inFileAddr);
+	    LoadSegment(&noffH.readonlyData, vpn, into);
+#endif
+	    MapPage(vpn, frame);
+	    Prefetch(vpn);
+	}
     }
+
+    if (kernel->machine->tlb != NULL)
+	LoadTLB(vpn);
+    frameTable->vmLock->Release();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MapPage
+// 	Page "vpn" has been brought into "frame": make it valid.
+//	Called with the VM lock held.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::MapPage(int vpn, int frame)
+{
+    TranslationEntry *pte = &pageTable[vpn];
+
+    pte->physicalPage = frame;
+    pte->valid = TRUE;
+    pte->use = FALSE;
+    pte->dirty = FALSE;
+    lastUse[vpn] = kernel->stats->totalTicks;
+    numResident++;
+    if (numResident > usage->peakResident)
+	usage->peakResident = numResident;
+    kernel->frameTable->Unbusy(frame);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FindSegment
+// 	Return the segment holding the last byte of page "vpn" (the
+//	direction a sequential sweep goes), or NULL for the stack.
+//----------------------------------------------------------------------
+
+Segment *
+AddrSpace::FindSegment(int vpn)
+{
+    int addr = (vpn + 1) * PageSize - 1;
+    Segment *segs[4];
+    int n = 0;
+
+    segs[n++] = &noffH.code;
+#ifdef RDATA
+    segs[n++] = &noffH.readonlyData;
 #endif
+    segs[n++] = &noffH.initData;
+    segs[n++] = &noffH.uninitData;
 
-    delete executable;			// close file
-    return TRUE;			// success
+    for (int i = 0; i < n; i++) {
+	if (segs[i]->size > 0 && addr >= segs[i]->virtualAddr
+		&& addr < segs[i]->virtualAddr + segs[i]->size)
+	    return segs[i];
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Prefetch
+// 	Page "vpn" was just read in from the executable: also bring in
+//	the pages after it in the same segment (fault-around).  The
+//	number of pages read ahead doubles, up to PrefetchMax, each
+//	time the program faults right after the previous read-ahead,
+//	and halves otherwise.  All of them are read with one request
+//	to the executable; bss pages need no read at all.
+//
+//	We stop at the first page that is already resident or has a
+//	copy elsewhere, and never read ahead if that would push the
+//	pool below the pager's low watermark or this process over its
+//	resident-set limit.
+//
+//	Called with the VM lock held.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::Prefetch(int vpn)
+{
+    FrameTable *frameTable = kernel->frameTable;
+    Segment *seg = FindSegment(vpn);
+    unsigned int segEnd, start, end, page;
+    int count, frame;
+    char *buffer, *into;
+
+    if (seg == NULL)
+	return;
+    if (vpn == nextSequential)
+	prefetchWindow = min(max(2 * prefetchWindow, 1), PrefetchMax);
+    else
+	prefetchWindow /= 2;
+
+    segEnd = seg->virtualAddr + seg->size;
+    for (count = 0; count < prefetchWindow; count++) {
+	page = vpn + 1 + count;
+	if (page >= numPages || page * PageSize >= segEnd)
+	    break;
+	if (pageTable[page].valid || pageTable[page].physicalPage >= 0
+		|| swapSector[page] >= 0)
+	    break;
+    }
+    count = min(count, frameTable->NumFree() - PagerLowWater);
+    count = min(count, frameTable->ResidentLimit() - numResident);
+    if (count <= 0) {
+	nextSequential = vpn + 1;
+	return;
+    }
+    nextSequential = vpn + 1 + count;
+
+    start = (vpn + 1) * PageSize;
+    end = min(start + count * PageSize, segEnd);
+    buffer = new char[count * PageSize];
+    bzero(buffer, count * PageSize);
+    if (seg != &noffH.uninitData)
+	image->ReadAt(buffer, end - start,
+			seg->inFileAddr + (start - seg->virtualAddr));
+    DEBUG(dbgAddr, "Prefetching " << count << " pages after " << vpn);
+
+    for (int i = 0; i < count; i++) {
+	page = vpn + 1 + i;
+	frame = frameTable->Allocate(this, page);
+	if (frame < 0)
+	    break;			// out of swap space
+	into = &(kernel->machine->mainMemory[frame * PageSize]);
+	bcopy(buffer + i * PageSize, into, PageSize);
+	if (page * PageSize + PageSize > segEnd) {  // shares its last page
+	    if (seg != &noffH.code)		    // with the next segment
+		LoadSegment(&noffH.code, page, into);
+	    if (seg != &noffH.initData)
+		LoadSegment(&noffH.initData, page, into);
+#ifdef RDATA
+	    if (seg != &noffH.readonlyData)
+		LoadSegment(&noffH.readonlyData, page, into);
+#endif
+	}
+	MapPage(page, frame);
+	prefetched[page] = TRUE;
+	kernel->stats->numPrefetches++;
+    }
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CountPrefetch
+// 	Page "vpn" is leaving memory.  If it was read ahead, count
+//	whether it was ever referenced.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::CountPrefetch(int vpn)
+{
+    if (!prefetched[vpn])
+	return;
+    prefetched[vpn] = FALSE;
+    if (pageTable[vpn].use)
+	kernel->stats->numPrefetchHits++;
+    else
+	kernel->stats->numPrefetchWaste++;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadTLB
+// 	Put the translation for page "vpn" into the TLB, replacing the
+//	entries round robin.  The use and dirty bits of the replaced
+//	entry go back to the page table.  For a page in a large page,
+//	the large entry is loaded, so that it covers the whole region.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadTLB(int vpn)
+{
+    TranslationEntry *tlb = kernel->machine->tlb;
+    TranslationEntry *entry = &tlb[tlbNext];
+    int base = vpn & ~(LargePagePages - 1);
+
+    ASSERT(tlbSpace == this);
+    tlbNext = (tlbNext + 1) % TLBSize;
+
+    if (entry->valid) {
+	pageTable[entry->virtualPage].use |= entry->use;
+	pageTable[entry->virtualPage].dirty |= entry->dirty;
+    }
+    if (pageTable[base].large)
+	*entry = pageTable[base];
+    else
+	*entry = pageTable[vpn];
+    ASSERT(entry->valid);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SyncTLB
+// 	If the TLB holds our translations, fold its use and dirty bits
+//	into the page table (and clear them in the TLB), so that the
+//	page table tells the whole story.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::SyncTLB()
+{
+    TranslationEntry *tlb = kernel->machine->tlb;
+
+    if (tlb == NULL || tlbSpace != this)
+	return;
+    for (int i = 0; i < TLBSize; i++) {
+	if (!tlb[i].valid)
+	    continue;
+	pageTable[tlb[i].virtualPage].use |= tlb[i].use;
+	pageTable[tlb[i].virtualPage].dirty |= tlb[i].dirty;
+	tlb[i].use = tlb[i].dirty = FALSE;
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Unmap
+// 	Take page "vpn" out of memory, so that its frame can be reused.
+//	The page table entry keeps the frame number, so that the page
+//	can be reclaimed if it is touched again before the frame is
+//	handed to somebody else.
+//
+//	Returns TRUE if the page was modified, and so has to be written
+//	to swap before the frame is reused.  Called with the VM lock held.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::Unmap(int vpn)
+{
+    TranslationEntry *pte = &pageTable[vpn];
+    TranslationEntry *tlb = kernel->machine->tlb;
+    bool dirty;
+
+    ASSERT(pte->valid && !InLargePage(vpn));
+    SyncTLB();
+    if (tlb != NULL && tlbSpace == this) {
+	for (int i = 0; i < TLBSize; i++) {
+	    if (tlb[i].valid && tlb[i].virtualPage == vpn)
+		tlb[i].valid = FALSE;
+	}
+    }
+    dirty = pte->dirty;
+    DEBUG(dbgAddr, "Unmapping page " << vpn << " from frame " << pte->physicalPage);
+
+    CountPrefetch(vpn);
+    if (pte->use)
+	lastUse[vpn] = kernel->stats->totalTicks;
+    pte->valid = FALSE;
+    pte->dirty = FALSE;
+    numResident--;
+    return dirty;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SwapSector
+// 	Return the swap sector backing page "vpn", allocating one the
+//	first time the page is written back; -1 if the swap area is
+//	full.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::SwapSector(int vpn)
+{
+    if (swapSector[vpn] < 0)
+	swapSector[vpn] = kernel->frameTable->AllocSwap();
+    return swapSector[vpn];
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Forget
+// 	The frame that last held page "vpn" is being reused; the page
+//	can no longer be reclaimed and must be read in on its next fault.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::Forget(int vpn)
+{
+    ASSERT(!pageTable[vpn].valid);
+    pageTable[vpn].physicalPage = -1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TestAndClearUse
+// 	Sample the hardware use bit of page "vpn".  If it is set, the
+//	page was referenced since the last sample: remember when, and
+//	clear the bit for the next sampling period.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::TestAndClearUse(int vpn)
+{
+    SyncTLB();
+    if (!pageTable[vpn].use)
+	return FALSE;
+    CountPrefetch(vpn);
+    pageTable[vpn].use = FALSE;
+    lastUse[vpn] = kernel->stats->totalTicks;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::WorkingSetSize
+// 	Return the number of pages referenced within the last
+//	working set window, whether or not they are still resident.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::WorkingSetSize()
+{
+    int now = kernel->stats->totalTicks;
+    int window = kernel->frameTable->Window();
+    int count = 0;
+
+    for (unsigned int i = 0; i < numPages; i++) {
+	if ((pageTable[i].valid && (pageTable[i].use || InLargePage(i)))
+				|| now - lastUse[i] <= window)
+	    count++;
+    }
+    return count;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::UserToKernel
+// 	Return the address in mainMemory of user virtual address
+//	"vaddr", bringing its page in if it is not resident.  The
+//	use and dirty bits are set as if the program made the access.
+//	Returns NULL if "vaddr" is not in the address space (or, when
+//	"isReadWrite", is read-only).
+//----------------------------------------------------------------------
+
+char *
+AddrSpace::UserToKernel(unsigned int vaddr, int isReadWrite)
+{
+    unsigned int paddr;
+    ExceptionType exception;
+
+    for (;;) {
+	exception = Translate(vaddr, &paddr, isReadWrite);
+	if (exception == NoException)
+	    return &(kernel->machine->mainMemory[paddr]);
+	if (exception != PageFaultException || !PageFault(vaddr))
+	    return NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CopyIn
+// 	Copy "size" bytes from user virtual address "vaddr" into the
+//	kernel buffer "into".  Each page is translated once and copied
+//	with a single bcopy.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::CopyIn(unsigned int vaddr, char *into, int size)
+{
+    char *from;
+    int chunk;
+
+    while (size > 0) {
+	chunk = min(size, PageSize - (int)(vaddr % PageSize));
+	if ((from = UserToKernel(vaddr, FALSE)) == NULL)
+	    return FALSE;
+	bcopy(from, into, chunk);
+	vaddr += chunk;
+	into += chunk;
+	size -= chunk;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CopyOut
+// 	Copy "size" bytes from the kernel buffer "from" to user virtual
+//	address "vaddr", a page at a time.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::CopyOut(unsigned int vaddr, char *from, int size)
+{
+    char *into;
+    int chunk;
+
+    while (size > 0) {
+	chunk = min(size, PageSize - (int)(vaddr % PageSize));
+	if ((into = UserToKernel(vaddr, TRUE)) == NULL)
+	    return FALSE;
+	bcopy(from, into, chunk);
+	vaddr += chunk;
+	from += chunk;
+	size -= chunk;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::InSpace
+// 	Return TRUE if the "size" bytes at user virtual address "vaddr"
+//	are all in the address space, so that a system call can check
+//	a buffer before it allocates or does anything for it.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::InSpace(unsigned int vaddr, int size)
+{
+    unsigned int spaceSize = numPages * PageSize;
+
+    return size >= 0 && vaddr <= spaceSize
+	&& (unsigned int) size <= spaceSize - vaddr;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CopyInString
+// 	Copy the null-terminated string at user virtual address "vaddr"
+//	into "into", which holds "maxLength" bytes.  Returns the length
+//	of the string, or -1 if it is not in the address space or does
+//	not fit.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::CopyInString(unsigned int vaddr, char *into, int maxLength)
+{
+    char *from, *end;
+    int chunk, length = 0;
+
+    while (length < maxLength) {
+	chunk = min(maxLength - length, PageSize - (int)(vaddr % PageSize));
+	if ((from = UserToKernel(vaddr, FALSE)) == NULL)
+	    return -1;
+	end = (char *) memchr(from, '\0', chunk);
+	if (end != NULL) {
+	    bcopy(from, into + length, end - from + 1);
+	    return length + (end - from);
+	}
+	bcopy(from, into + length, chunk);
+	vaddr += chunk;
+	length += chunk;
+    }
+    return -1;				// no room for the terminator
 }
 
 //----------------------------------------------------------------------
@@ -215,9 +793,10 @@ AddrSpace::Execute(char* fileName)
 {
 
     kernel->currentThread->space = this;
+    kernel->currentThread->RestoreUserState();	// our registers
 
     this->InitRegisters();		// set the initial register values
-    this->RestoreState();		// load page table register
+    kernel->scheduler->LoadSpace(this);	// load page table register
 
     kernel->machine->Run();		// jump to the user progam
 
@@ -227,14 +806,112 @@ AddrSpace::Execute(char* fileName)
 }
 
 
+//----------------------------------------------------------------------
+// AddrSpace::AddStack
+// 	Make room for the stack of one more thread running in this
+//	space, above everything that is there already.  The new pages
+//	are zero-filled on demand, like the first stack.  Returns the
+//	initial stack pointer, or -1 if the space would outgrow swap.
+//
+//	The page table is replaced by a larger copy; if the machine is
+//	using the old one (no TLB), it is told about the new one.  The
+//	stacks of threads that have finished are not reused.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::AddStack()
+{
+    FrameTable *frameTable = kernel->frameTable;
+    Machine *machine = kernel->machine;
+    unsigned int newPages = numPages + divRoundUp(UserStackSize, PageSize);
+    TranslationEntry *oldTable = pageTable;
+    int *oldSector = swapSector;
+    int *oldUse = lastUse;
+    bool *oldPrefetched = prefetched;
+
+    if (newPages > NumSwapSectors)	// every page must fit in swap
+	return -1;
+
+    frameTable->vmLock->Acquire();
+    if (tlbSpace == this)
+	SyncTLB();
+    pageTable = new TranslationEntry[newPages];
+    swapSector = new int[newPages];
+    lastUse = new int[newPages];
+    prefetched = new bool[newPages];
+    for (unsigned int i = 0; i < newPages; i++) {
+	if (i < numPages) {
+	    pageTable[i] = oldTable[i];
+	    swapSector[i] = oldSector[i];
+	    lastUse[i] = oldUse[i];
+	    prefetched[i] = oldPrefetched[i];
+	    continue;
+	}
+	pageTable[i].virtualPage = i;
+	pageTable[i].physicalPage = -1;
+	pageTable[i].valid = FALSE;
+	pageTable[i].use = FALSE;
+	pageTable[i].dirty = FALSE;
+	pageTable[i].readOnly = FALSE;
+	pageTable[i].large = FALSE;
+	swapSector[i] = -1;
+	prefetched[i] = FALSE;
+	lastUse[i] = -frameTable->Window() - 1;
+    }
+    if (machine->pageTable == oldTable) {
+	machine->pageTable = pageTable;
+	machine->pageTableSize = newPages;
+    }
+    numPages = newPages;
+    frameTable->vmLock->Release();
+
+    delete [] oldTable;
+    delete [] oldSector;
+    delete [] oldUse;
+    delete [] oldPrefetched;
+
+    DEBUG(dbgAddr, "Added a stack, address space now " << numPages
+		<< " pages");
+    return numPages * PageSize - 16;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ExecuteThread
+// 	Run the user function at address "func", in a thread forked
+//	from a program already running in this space, on the stack
+//	whose initial stack pointer is "stackTop" (from AddStack).
+//
+//	The function has nothing to return to; it must end by calling
+//	ThreadExit (or Exit).
+//----------------------------------------------------------------------
+
+void
+AddrSpace::ExecuteThread(int func, int stackTop)
+{
+    Machine *machine = kernel->machine;
+
+    kernel->currentThread->RestoreUserState();	// our registers
+
+    for (int i = 0; i < NumTotalRegs; i++)
+	machine->WriteRegister(i, 0);
+    machine->WriteRegister(PCReg, func);
+    machine->WriteRegister(NextPCReg, func + 4);
+    machine->WriteRegister(StackReg, stackTop);
+    kernel->scheduler->LoadSpace(this);	// load page table register
+
+    machine->Run();			// jump to the user function
+
+    ASSERTNOTREACHED();
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::InitRegisters
 // 	Set the initial values for the user-level register set.
 //
 // 	We write these directly into the "machine" registers, so
-//	that we can immediately jump to user code.  Note that these
-//	will be saved/restored into the currentThread->userRegisters
-//	when this thread is context switched out.
+//	that we can immediately jump to user code.  Note that the
+//	machine registers are the currentThread->userRegisters, and
+//	stay with the thread when it is context switched out.
 //----------------------------------------------------------------------
 
 void
@@ -268,24 +945,46 @@ AddrSpace::InitRegisters()
 // 	On a context switch, save any machine state, specific
 //	to this address space, that needs saving.
 //
-//	For now, don't need to save anything!
+//	For now, fold the TLB reference bits into the page table, and
+//	charge the user time spent since RestoreState to this process,
+//	for the paging statistics.
 //----------------------------------------------------------------------
 
 void AddrSpace::SaveState()
-{}
+{
+    SyncTLB();
+    if (usage != NULL)
+	usage->ticks += kernel->stats->userTicks - runStart;
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::RestoreState
 // 	On a context switch, restore the machine state so that
 //	this address space can run.
 //
-//      For now, tell the machine where to find the page table.
+//      For now, tell the machine where to find the page table, or
+//	if there is a TLB, flush it; it is refilled on TLB misses.
+//	If the TLB still holds our translations -- nobody else ran a
+//	user program since -- they are still good, so keep them.
 //----------------------------------------------------------------------
 
 void AddrSpace::RestoreState()
 {
-    kernel->machine->pageTable = pageTable;
-    kernel->machine->pageTableSize = numPages;
+    Machine *machine = kernel->machine;
+
+    runStart = kernel->stats->userTicks;
+    if (machine->tlb != NULL) {
+	if (tlbSpace == this)
+	    return;
+	if (tlbSpace != NULL)
+	    tlbSpace->SyncTLB();
+	for (int i = 0; i < TLBSize; i++)
+	    machine->tlb[i].valid = FALSE;
+	tlbSpace = this;
+    } else {
+	machine->pageTable = pageTable;
+	machine->pageTableSize = numPages;
+    }
 }
 
 
@@ -309,13 +1008,20 @@ AddrSpace::Translate(unsigned int vaddr, unsigned int *paddr, int isReadWrite)
         return AddressErrorException;
     }
 
-    pte = &pageTable[vpn];
+    pte = &pageTable[vpn & ~(LargePagePages - 1)];
+    if(!(pte->valid && pte->large)) {
+        pte = &pageTable[vpn];
+    }
+
+    if(!pte->valid) {
+        return PageFaultException;
+    }
 
     if(isReadWrite && pte->readOnly) {
         return ReadOnlyException;
     }
 
-    pfn = pte->physicalPage;
+    pfn = pte->physicalPage + (vpn - pte->virtualPage);
 
     // if the pageFrame is too big, there is something really wrong!
     // An invalid translation was loaded into the page table or TLB.
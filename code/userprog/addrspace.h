@@ -2,9 +2,11 @@
 //	Data structures to keep track of executing user programs
 //	(address spaces).
 //
-//	For now, we don't keep any information about address spaces.
-//	The user level CPU state is saved and restored in the thread
-//	executing the user program (see thread.h).
+//	Pages are brought into memory on demand, the first time the
+//	program touches them, and may be evicted to the swap area when
+//	memory runs short (see frametable.h).  The user level CPU state
+//	is saved and restored in the thread executing the user program
+//	(see thread.h).
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -16,8 +18,13 @@
 #include "copyright.h"
 #include "filesys.h"
 #include "list.h"
+#include "noff.h"
+
+class VMUsage;
+class ExecImage;
 
 #define UserStackSize		1024 	// increase this as necessary!
+#define PrefetchMax		8	// most pages read ahead on one fault
 
 class AddrSpace {
   public:
@@ -33,6 +40,18 @@ class AddrSpace {
 					// assumes the program has already
                                         // been loaded
 
+    // Several threads may run in one address space (see ThreadFork);
+    // the space goes away with the last of them.
+    void Attach() { numThreads++; }	// One more thread runs in here
+    bool Detach() { return --numThreads == 0; }
+					// One less; TRUE if it was the last
+    int AddStack();			// Grow the space by a stack for a
+					// new thread; returns its initial
+					// stack pointer, -1 if out of room
+    void ExecuteThread(int func, int stackTop);
+					// Run the user function at "func"
+					// on the stack at "stackTop"
+
     void SaveState();			// Save/restore address space-specific
     void RestoreState();		// info on a context switch
 
@@ -41,14 +60,71 @@ class AddrSpace {
     // is 0 for Read, 1 for Write.
     ExceptionType Translate(unsigned int vaddr, unsigned int *paddr, int mode);
 
+    bool PageFault(unsigned int vaddr);	// Bring the page containing
+					// _vaddr_ into memory; FALSE if
+					// _vaddr_ is outside the space
+    bool Unmap(int vpn);		// Take page _vpn_ out of memory;
+					// TRUE if it must be written back
+    int SwapSector(int vpn);		// Swap sector holding page _vpn_
+    bool HasSwap(int vpn) { return swapSector[vpn] >= 0; }
+					// Does _vpn_ have one yet?
+    void Forget(int vpn);		// The frame last holding _vpn_
+					// was reused
+
+    // Copy between kernel memory and user virtual memory, a page
+    // at a time, faulting pages in as needed.  They return FALSE
+    // (or -1) if the user buffer is not entirely in the space.
+    bool CopyIn(unsigned int vaddr, char *into, int size);
+    bool CopyOut(unsigned int vaddr, char *from, int size);
+    int CopyInString(unsigned int vaddr, char *into, int maxLength);
+					// Returns the string length
+    bool InSpace(unsigned int vaddr, int size);
+					// Is the user buffer entirely
+					// in the space?
+
+    bool TestAndClearUse(int vpn);	// Sample the use bit of _vpn_
+    int LastUse(int vpn) { return lastUse[vpn]; }
+    int NumResident() { return numResident; }
+    int WorkingSetSize();		// Pages referenced within the
+					// working set window
+
   private:
     TranslationEntry *pageTable;	// Assume linear page table translation
 					// for now!
     unsigned int numPages;		// Number of pages in the virtual
 					// address space
 
+    ExecImage *image;			// where non-resident, never swapped
+    NoffHeader noffH;			// pages are loaded from
+    int numThreads;			// threads running in this space
+    int *swapSector;			// swap copy of each page, -1 if none
+    int *lastUse;			// last tick each page was seen used
+    int numResident;			// pages currently in memory
+    VMUsage *usage;			// paging statistics for this process
+    int runStart;			// userTicks when last scheduled
+
+    bool *prefetched;			// read ahead, not referenced yet
+    int prefetchWindow;			// pages to read ahead on next fault
+    int nextSequential;			// fault here means sequential access
+
     void InitRegisters();		// Initialize user-level CPU registers,
 					// before jumping to user code
+    void LoadSegment(Segment *seg, int vpn, char *into);
+					// Copy the part of "seg" that falls
+					// in page "vpn" from the executable
+    char *UserToKernel(unsigned int vaddr, int isReadWrite);
+					// Where "vaddr" is in mainMemory
+    void MapLargePages();		// Map aligned regions as large pages
+    bool InLargePage(int vpn)		// Is "vpn" mapped by a large page?
+	{ return pageTable[vpn & ~(LargePagePages - 1)].large; }
+    void LoadTLB(int vpn);		// Put the translation of "vpn" in
+					// the TLB, after a TLB miss
+    void SyncTLB();			// Copy the TLB use and dirty bits
+					// back to the page table
+    Segment *FindSegment(int vpn);	// Segment the end of "vpn" is in
+    void Prefetch(int vpn);		// Read ahead the pages after "vpn"
+    void MapPage(int vpn, int frame);	// Page "vpn" is now in "frame"
+    void CountPrefetch(int vpn);	// Was a read-ahead page useful?
 
 };
 
@@ -25,6 +25,10 @@
 #include "main.h"
 #include "syscall.h"
 #include "ksyscall.h"
+
+// Longest file name or message a program may pass to the kernel.
+#define MaxStringLength 256
+
 //----------------------------------------------------------------------
 // ExceptionHandler
 // 	Entry point into the Nachos kernel.  Called when a user program
@@ -72,8 +76,12 @@ ExceptionHandler(ExceptionType which)
         case SC_Open:
             val = kernel->machine->ReadRegister(4);
             {
-            char *filename = &(kernel->machine->mainMemory[val]);
-            status = (int) SysOpen(filename);
+            char filename[MaxStringLength];
+            if (kernel->currentThread->space->CopyInString(val, filename,
+                                                MaxStringLength) < 0)
+                status = -1;
+            else
+                status = (int) SysOpen(filename);
             kernel->machine->WriteRegister(2, (int) status);
             }
             kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -88,8 +96,17 @@ ExceptionHandler(ExceptionType which)
             int buffer = kernel->machine->ReadRegister(4);
             int size = kernel->machine->ReadRegister(5);
             int id = kernel->machine->ReadRegister(6);
-            char* cbuffer = &(kernel->machine->mainMemory[buffer]);
-            status = (int) SysWrite(cbuffer , size , id);
+            AddrSpace *space = kernel->currentThread->space;
+            if (!space->InSpace(buffer, size))  // check before allocating
+                status = -1;
+            else {
+                char* cbuffer = new char[max(size, 1)];
+                if (!space->CopyIn(buffer, cbuffer, size))
+                    status = -1;
+                else
+                    status = (int) SysWrite(cbuffer , size , id);
+                delete [] cbuffer;
+            }
             kernel->machine->WriteRegister(2, (int) status);
             }
             kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -104,8 +121,16 @@ ExceptionHandler(ExceptionType which)
             int buffer = kernel->machine->ReadRegister(4);
             int size = kernel->machine->ReadRegister(5);
             int id = kernel->machine->ReadRegister(6);
-            char* cbuffer = &(kernel->machine->mainMemory[buffer]);
-            status = (int) SysRead(cbuffer , size , id);
+            AddrSpace *space = kernel->currentThread->space;
+            if (!space->InSpace(buffer, size))  // check before reading
+                status = -1;
+            else {
+                char* cbuffer = new char[max(size, 1)];
+                status = (int) SysRead(cbuffer , size , id);
+                if (status > 0 && !space->CopyOut(buffer, cbuffer, status))
+                    status = -1;
+                delete [] cbuffer;
+            }
             kernel->machine->WriteRegister(2, (int) status);
             }
             kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -136,8 +161,10 @@ ExceptionHandler(ExceptionType which)
 			DEBUG(dbgSys, "Message received.\n");
 			val = kernel->machine->ReadRegister(4);
 			{
-			char *msg = &(kernel->machine->mainMemory[val]);
-			cout << msg << endl;
+			char msg[MaxStringLength];
+			if (kernel->currentThread->space->CopyInString(val, msg,
+							MaxStringLength) >= 0)
+				cout << msg << endl;
 			}
 			SysHalt();
 			ASSERTNOTREACHED();
@@ -145,9 +172,12 @@ ExceptionHandler(ExceptionType which)
 		case SC_Create:
 			val = kernel->machine->ReadRegister(4);
 			{
-			char *filename = &(kernel->machine->mainMemory[val]);
-			//cout << filename << endl;
-			status = SysCreate(filename);
+			char filename[MaxStringLength];
+			if (kernel->currentThread->space->CopyInString(val, filename,
+							MaxStringLength) < 0)
+				status = 0;
+			else
+				status = SysCreate(filename);
 			kernel->machine->WriteRegister(2, (int) status);
 			}
 			kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -156,6 +186,60 @@ ExceptionHandler(ExceptionType which)
 			return;
 			ASSERTNOTREACHED();
             break;
+        case SC_Exec:
+            val = kernel->machine->ReadRegister(4);
+            {
+            char filename[MaxStringLength];
+            if (kernel->currentThread->space->CopyInString(val, filename,
+                                                MaxStringLength) < 0)
+                status = -1;
+            else
+                status = SysExec(filename);
+            DEBUG(dbgSys, "Exec returning " << status << "\n");
+            kernel->machine->WriteRegister(2, status);
+            }
+            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
+            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+            return;
+			ASSERTNOTREACHED();
+            break;
+
+        case SC_Join:
+        case SC_ThreadJoin:
+            threadID = kernel->machine->ReadRegister(4);
+            status = SysJoin(threadID);
+            DEBUG(dbgSys, "Join " << threadID << " returning " << status << "\n");
+            kernel->machine->WriteRegister(2, status);
+            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
+            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+            return;
+			ASSERTNOTREACHED();
+            break;
+
+        case SC_ThreadFork:
+            val = kernel->machine->ReadRegister(4);
+            threadID = SysThreadFork(val);
+            DEBUG(dbgSys, "ThreadFork " << val << " returning " << threadID << "\n");
+            kernel->machine->WriteRegister(2, threadID);
+            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
+            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+            return;
+			ASSERTNOTREACHED();
+            break;
+
+        case SC_Sleep:
+			val = kernel->machine->ReadRegister(4);
+			DEBUG(dbgSys, "Sleep " << val << " ticks\n");
+			SysSleep(val);
+			kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+			kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
+			kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+			return;
+			ASSERTNOTREACHED();
+            break;
       	case SC_Add:
 			DEBUG(dbgSys, "Add " << kernel->machine->ReadRegister(4) << " + " << kernel->machine->ReadRegister(5) << "\n");
 			/* Process SysAdd Systemcall*/
@@ -184,13 +268,26 @@ ExceptionHandler(ExceptionType which)
 			DEBUG(dbgAddr, "Program exit\n");
             val=kernel->machine->ReadRegister(4);
             cout << "return value:" << val << endl;
-			kernel->currentThread->Finish();
+			SysExit(val);
             break;
+		case SC_ThreadExit:
+			val = kernel->machine->ReadRegister(4);
+			DEBUG(dbgSys, "Thread exit " << val << "\n");
+			SysExit(val);
+			break;
       	default:
 			cerr << "Unexpected system call " << type << "\n";
 			break;
 		}
 		break;
+	case PageFaultException:
+		/* MP2 demand paging, the faulting instruction is retried */
+		val = kernel->machine->ReadRegister(BadVAddrReg);
+		if (kernel->currentThread->space->PageFault(val))
+			return;
+		cerr << "Can't page in address " << val << "\n";
+		kernel->currentThread->Finish();
+		break;
 	default:
 		cerr << "Unexpected user mode exception " << (int)which << "\n";
 		break;
@@ -0,0 +1,568 @@
+// frametable.cc
+//	Routines to manage physical page frames and swap sectors on
+//	behalf of user address spaces.
+//
+//	Replacement is done with a WSClock sweep over the core map:
+//	a frame whose use bit is set gets a second chance (and its
+//	page is noted as recently used); otherwise the first frame
+//	whose page has fallen out of its owner's working set is
+//	taken.  If every page is in some working set, the first
+//	unreferenced page seen is used instead.
+//
+//	A process that already holds its resident-set limit only
+//	replaces its own pages (local replacement), so a single memory
+//	hog thrashes by itself rather than stealing everyone's frames.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "frametable.h"
+#include "addrspace.h"
+#include "machine.h"
+#include "synch.h"
+#include "synchdisk.h"
+
+//----------------------------------------------------------------------
+// VMUsage::VMUsage
+// 	Initialize the paging statistics of a newly loaded program.
+//----------------------------------------------------------------------
+
+VMUsage::VMUsage(char *progName, int threadID)
+{
+    space = NULL;
+    name = progName;
+    id = threadID;
+    resident = peakResident = workingSet = 0;
+    faults = ticks = 0;
+}
+
+//----------------------------------------------------------------------
+// VMUsage::Print
+// 	Print resident set size, working set size and fault rate
+//	(faults per 1000 user ticks) of one process.
+//----------------------------------------------------------------------
+
+void
+VMUsage::Print()
+{
+    if (space != NULL) {		// still running, sample it now
+	resident = space->NumResident();
+	workingSet = space->WorkingSetSize();
+    }
+    cout << "Thread " << id << " (" << name << "): RSS " << resident;
+    cout << " (peak " << peakResident << "), working set " << workingSet;
+    cout << ", faults " << faults << ", fault rate ";
+    cout << (ticks > 0 ? (faults * 1000.0) / ticks : 0.0);
+    cout << " per 1000 ticks\n";
+}
+
+//----------------------------------------------------------------------
+// FrameTable::FrameTable
+// 	Initialize the core map.  All frames start out free, and the
+//	swap area at the end of the simulated disk (see disk.h) is
+//	all available.  The pager
+//	thread is not started until the first page fault, so that
+//	kernels that never run a user program don't see it.
+//
+//	"rssLimit" is the largest number of frames one process may hold
+//	"wsWindow" is the working set window, in ticks
+//	"useLargePages" is TRUE to map aligned regions with large pages
+//----------------------------------------------------------------------
+
+FrameTable::FrameTable(int rssLimit, int wsWindow, bool useLargePages)
+{
+    frames = new FrameEntry[NumPhysPages];
+    freeFrames = new List<int>;
+    for (int i = 0; i < NumPhysPages; i++) {
+	frames[i].space = NULL;
+	frames[i].virtualPage = -1;
+	frames[i].busy = FALSE;
+	frames[i].free = TRUE;
+	frames[i].sector = -1;
+	frames[i].pinned = FALSE;
+	freeFrames->Append(i);
+    }
+    dirtyFrames = new List<int>;
+    swapMap = new Bitmap(NumSwapSectors);
+    usages = new List<VMUsage *>;
+    vmLock = new Lock("vm");
+    pagerWake = new Condition("pager wake");
+    frameFreed = new Condition("frame freed");
+    pagerThread = NULL;
+
+    hand = 0;
+    residentLimit = (rssLimit > 0) ? rssLimit : NumPhysPages;
+    window = wsWindow;
+    nextSample = 0;
+    largePages = useLargePages;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::~FrameTable
+// 	De-allocate the core map.
+//----------------------------------------------------------------------
+
+FrameTable::~FrameTable()
+{
+    while (!usages->IsEmpty())
+	delete usages->RemoveFront();
+    delete usages;
+    delete frameFreed;
+    delete pagerWake;
+    delete vmLock;
+    delete swapMap;
+    delete dirtyFrames;
+    delete freeFrames;
+    delete [] frames;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::ChooseVictim
+// 	Sweep the clock hand over the core map looking for a frame
+//	to evict, as described at the top of this file.  Returns -1
+//	if no frame qualifies (all of them free or busy, or none owned
+//	by "space").  A page that would need a swap sector when there
+//	are none left is not taken.
+//
+//	"space" -- if non-NULL, only consider frames it owns
+//----------------------------------------------------------------------
+
+int
+FrameTable::ChooseVictim(AddrSpace *space)
+{
+    int now = kernel->stats->totalTicks;
+    int candidate = -1;
+    FrameEntry *entry;
+    int frame;
+
+    for (int i = 0; i < 2 * NumPhysPages; i++) {
+	frame = hand;
+	hand = (hand + 1) % NumPhysPages;
+	entry = &frames[frame];
+
+	if (entry->space == NULL || entry->free || entry->busy
+						|| entry->pinned)
+	    continue;
+	if (space != NULL && entry->space != space)
+	    continue;
+	if (!CanPageOut(entry))
+	    continue;			// nowhere to write it
+	if (entry->space->TestAndClearUse(entry->virtualPage))
+	    continue;			// referenced: second chance
+	if (now - entry->space->LastUse(entry->virtualPage) > window)
+	    return frame;		// out of its working set
+	if (candidate < 0)
+	    candidate = frame;
+    }
+    return candidate;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::CanPageOut
+// 	Return TRUE if the page in "entry" can be taken away: it already
+//	has a swap sector, or one is left.  Whether it is dirty is only
+//	known once it is unmapped, so a clean page is treated the same.
+//----------------------------------------------------------------------
+
+bool
+FrameTable::CanPageOut(FrameEntry *entry)
+{
+    return entry->space->HasSwap(entry->virtualPage)
+		|| swapMap->NumClear() > 0;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::CanFreeFrame
+// 	Return TRUE if a frame may yet come back to the free pool: one
+//	is being written back by the pager, or some page can still be
+//	paged out.  If not, memory and swap are full.
+//----------------------------------------------------------------------
+
+bool
+FrameTable::CanFreeFrame()
+{
+    FrameEntry *entry;
+
+    for (int i = 0; i < NumPhysPages; i++) {
+	entry = &frames[i];
+	if (entry->busy && entry->sector >= 0)
+	    return TRUE;		// the pager is writing it
+	if (entry->space != NULL && !entry->free && !entry->busy
+		&& !entry->pinned && CanPageOut(entry))
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::MakeFree
+// 	Put "frame" at the end of the free pool.  Whatever page it
+//	held stays there, and can be reclaimed until the frame reaches
+//	the front of the pool and is handed out again.
+//----------------------------------------------------------------------
+
+void
+FrameTable::MakeFree(int frame)
+{
+    frames[frame].free = TRUE;
+    frames[frame].busy = FALSE;
+    frames[frame].pinned = FALSE;
+    frames[frame].sector = -1;
+    freeFrames->Append(frame);
+}
+
+//----------------------------------------------------------------------
+// FrameTable::PageOut
+// 	Take the page in "frame" away from its owner.  A clean page
+//	can go straight to the free pool; a dirty one is left busy on
+//	the pager's queue, to be written to its swap sector.
+//
+//	Called with the VM lock held.
+//----------------------------------------------------------------------
+
+void
+FrameTable::PageOut(int frame)
+{
+    FrameEntry *entry = &frames[frame];
+
+    if (entry->space->Unmap(entry->virtualPage)) {	// dirty
+	entry->busy = TRUE;
+	entry->sector = entry->space->SwapSector(entry->virtualPage);
+	ASSERT(entry->sector >= 0);	// see CanPageOut
+	dirtyFrames->Append(frame);
+    } else {
+	MakeFree(frame);
+    }
+}
+
+//----------------------------------------------------------------------
+// PagerThread
+// 	Entry point of the pager thread, see FrameTable::Pager.
+//----------------------------------------------------------------------
+
+static void
+PagerThread(FrameTable *frameTable)
+{
+    frameTable->Pager();
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Allocate
+// 	Find a frame to hold page "vpn" of "space".  A process at its
+//	resident-set limit first gives up one of its own pages; then
+//	we take the oldest frame in the free pool, waiting for the
+//	pager to refill it if it is empty.  The faulting thread never
+//	writes a dirty page back itself.
+//
+//	Called with the VM lock held.  The frame is returned marked
+//	busy; the caller clears that once the page has been read in.
+//	Returns -1 if the pool is empty and can't be refilled, because
+//	every page in memory would need a swap sector and there are
+//	none left.
+//----------------------------------------------------------------------
+
+int
+FrameTable::Allocate(AddrSpace *space, int vpn)
+{
+    int frame;
+
+    if (pagerThread == NULL) {
+	pagerThread = new Thread("pager", 1, PagerPriority);
+	pagerThread->Fork((VoidFunctionPtr) PagerThread, (void *) this);
+    }
+
+    if (space->NumResident() >= residentLimit) {
+	frame = ChooseVictim(space);
+	if (frame >= 0)
+	    PageOut(frame);
+    }
+    while (freeFrames->IsEmpty()) {
+	if (!CanFreeFrame())
+	    return -1;
+	pagerWake->Signal(vmLock);
+	frameFreed->Wait(vmLock);
+    }
+    frame = freeFrames->RemoveFront();
+    if (NumFree() < PagerLowWater || !dirtyFrames->IsEmpty())
+	pagerWake->Signal(vmLock);
+
+    if (frames[frame].space != NULL)	// too late to reclaim it now
+	frames[frame].space->Forget(frames[frame].virtualPage);
+    frames[frame].space = space;
+    frames[frame].virtualPage = vpn;
+    frames[frame].free = FALSE;
+    frames[frame].busy = TRUE;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::AllocateLarge
+// 	Find LargePagePages consecutive free frames, starting at a
+//	multiple of LargePagePages, to hold the region of "space" that
+//	starts at page "vpn".  The frames are pinned: the region stays
+//	in memory until the address space goes away.
+//
+//	Returns -1 (and the caller falls back to ordinary pages) if no
+//	such run is free, or taking it would leave the pool below the
+//	pager's low watermark or "space" over its resident-set limit.
+//
+//	Called with the VM lock held.
+//----------------------------------------------------------------------
+
+int
+FrameTable::AllocateLarge(AddrSpace *space, int vpn)
+{
+    int first, i;
+
+    if (NumFree() - LargePagePages < PagerLowWater
+	    || space->NumResident() + LargePagePages > residentLimit)
+	return -1;
+
+    for (first = 0; first < NumPhysPages; first += LargePagePages) {
+	for (i = 0; i < LargePagePages; i++) {
+	    if (!frames[first + i].free)
+		break;
+	}
+	if (i == LargePagePages)
+	    break;
+    }
+    if (first >= NumPhysPages)
+	return -1;
+
+    for (i = 0; i < LargePagePages; i++) {
+	FrameEntry *entry = &frames[first + i];
+
+	freeFrames->Remove(first + i);
+	if (entry->space != NULL)
+	    entry->space->Forget(entry->virtualPage);
+	entry->space = space;
+	entry->virtualPage = vpn + i;
+	entry->free = FALSE;
+	entry->pinned = TRUE;
+    }
+    return first;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Reclaim
+// 	If "frame" is in the free pool and still holds page "vpn" of
+//	"space", take it out of the pool and give it back to its owner;
+//	no disk I/O is needed.
+//
+//	Called with the VM lock held.
+//----------------------------------------------------------------------
+
+bool
+FrameTable::Reclaim(AddrSpace *space, int vpn, int frame)
+{
+    FrameEntry *entry = &frames[frame];
+
+    if (!entry->free || entry->space != space || entry->virtualPage != vpn)
+	return FALSE;
+    freeFrames->Remove(frame);
+    entry->free = FALSE;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::PagingOut
+// 	Return TRUE if page "vpn" of "space" is on its way to disk
+//	from "frame"; the owner must then wait for the pager before
+//	touching the page again.
+//----------------------------------------------------------------------
+
+bool
+FrameTable::PagingOut(AddrSpace *space, int vpn, int frame)
+{
+    FrameEntry *entry = &frames[frame];
+
+    return entry->space == space && entry->virtualPage == vpn
+		&& entry->busy && entry->sector >= 0;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::WaitForPager
+// 	Wait until the pager has written back its current batch.
+//	Called with the VM lock held.
+//----------------------------------------------------------------------
+
+void
+FrameTable::WaitForPager()
+{
+    frameFreed->Wait(vmLock);
+}
+
+//----------------------------------------------------------------------
+// FrameTable::ReleaseSpace
+// 	"space" is going away: put the frames holding its pages back
+//	in the pool, and forget the pages it left in the pool.  Frames
+//	the pager is still writing are left to it; it frees them (and
+//	their swap sectors) once the write is done.
+//
+//	Called with the VM lock held.
+//----------------------------------------------------------------------
+
+void
+FrameTable::ReleaseSpace(AddrSpace *space)
+{
+    FrameEntry *entry;
+
+    for (int i = 0; i < NumPhysPages; i++) {
+	entry = &frames[i];
+	if (entry->space != space)
+	    continue;
+	entry->space = NULL;
+	entry->virtualPage = -1;
+	if (!entry->free && !entry->busy)
+	    MakeFree(i);
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Pager
+// 	Body of the pager thread.  Whenever the free pool drops below
+//	the low watermark, pick victims with the clock until the high
+//	watermark is in sight, then write the dirty ones back in order
+//	of swap sector (with the VM lock released, so that faults that
+//	can be served from the pool are not held up), and add them to
+//	the pool.
+//----------------------------------------------------------------------
+
+static int
+SectorCompare(FrameEntry *x, FrameEntry *y)
+{
+    if (x->sector < y->sector) return -1;
+    if (x->sector > y->sector) return 1;
+    return 0;
+}
+
+void
+FrameTable::Pager()
+{
+    SortedList<FrameEntry *> *batch;
+    FrameEntry *entry;
+    int frame;
+
+    batch = new SortedList<FrameEntry *>(SectorCompare);
+    vmLock->Acquire();
+    for (;;) {
+	while (NumFree() >= PagerLowWater && dirtyFrames->IsEmpty())
+	    pagerWake->Wait(vmLock);
+
+	while (NumFree() + dirtyFrames->NumInList() < PagerHighWater) {
+	    frame = ChooseVictim(NULL);
+	    if (frame < 0)
+		break;			// everything is busy or free
+	    PageOut(frame);
+	}
+	frameFreed->Broadcast(vmLock);	// for the clean victims
+	if (dirtyFrames->IsEmpty()) {	// nothing more we can do until
+	    pagerWake->Wait(vmLock);	// some fault is done with its
+	    continue;			// frame
+	}
+
+	while (!dirtyFrames->IsEmpty())
+	    batch->Insert(&frames[dirtyFrames->RemoveFront()]);
+	DEBUG(dbgAddr, "Pager writing back " << batch->NumInList() << " pages");
+
+	vmLock->Release();
+	ListIterator<FrameEntry *> iter(batch);
+	for (; !iter.IsDone(); iter.Next()) {
+	    entry = iter.Item();
+	    kernel->synchDisk->WriteSector(entry->sector,
+		&(kernel->machine->mainMemory[(entry - frames) * PageSize]));
+	    kernel->stats->numPageOuts++;
+	}
+	vmLock->Acquire();
+
+	while (!batch->IsEmpty()) {
+	    entry = batch->RemoveFront();
+	    if (entry->space == NULL && entry->sector >= 0)
+		FreeSwap(entry->sector);	// owner exited meanwhile
+	    MakeFree(entry - frames);
+	}
+	frameFreed->Broadcast(vmLock);
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::AllocSwap, FreeSwap
+// 	Allocate and free sectors of the swap area.  AllocSwap returns
+//	-1 if the swap area is full.
+//----------------------------------------------------------------------
+
+int
+FrameTable::AllocSwap()
+{
+    int i = swapMap->FindAndSet();
+
+    if (i < 0)
+	return -1;			// out of swap space
+    return FirstSwapSector + i;
+}
+
+void
+FrameTable::FreeSwap(int sector)
+{
+    ASSERT(sector >= FirstSwapSector && sector < NumSectors);
+    swapMap->Clear(sector - FirstSwapSector);
+}
+
+//----------------------------------------------------------------------
+// FrameTable::SampleReferences
+// 	Called on every timer interrupt.  Once per sampling interval,
+//	harvest and clear the use bit of every resident page, so that
+//	each address space knows roughly when its pages were last
+//	referenced.
+//----------------------------------------------------------------------
+
+void
+FrameTable::SampleReferences()
+{
+    int now = kernel->stats->totalTicks;
+
+    if (now < nextSample)
+	return;
+    nextSample = now + WorkingSetSampleInterval;
+
+    for (int i = 0; i < NumPhysPages; i++) {
+	if (frames[i].space != NULL && !frames[i].free && !frames[i].busy
+						&& !frames[i].pinned)
+	    frames[i].space->TestAndClearUse(frames[i].virtualPage);
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Register
+// 	Keep the paging statistics of a new process, for Print.
+//----------------------------------------------------------------------
+
+void
+FrameTable::Register(VMUsage *usage)
+{
+    usages->Append(usage);
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Print
+// 	Print the per-process paging statistics, at halt.
+//----------------------------------------------------------------------
+
+static void
+VMUsagePrint(VMUsage *usage)
+{
+    usage->Print();
+}
+
+void
+FrameTable::Print()
+{
+    if (usages->IsEmpty())
+	return;
+    cout << "Memory: resident limit " << residentLimit;
+    cout << " pages, working set window " << window << " ticks\n";
+    usages->Apply(VMUsagePrint);
+}
@@ -0,0 +1,171 @@
+// frametable.h
+//	Data structures to keep track of physical memory (the "core map")
+//	and of the swap area on disk, on behalf of user address spaces.
+//
+//	Each physical page frame remembers which address space and which
+//	virtual page currently live in it, so that the frame can be
+//	reclaimed when memory runs out.  Pages that are evicted while
+//	dirty are written to a swap sector on the simulated disk.
+//
+//	The frame table also samples the hardware "use" bits of every
+//	resident page from time to time, which lets each address space
+//	estimate its working set, and it enforces a per-process
+//	resident-set limit so one large program cannot push everybody
+//	else out of memory.
+//
+//	Page faults never write to disk themselves.  A kernel "pager"
+//	thread keeps a pool of clean free frames between a low and a
+//	high watermark, writing dirty victims back in batches sorted by
+//	swap sector.  A frame in the pool still remembers the page it
+//	held, so a fault on a page that was only just taken away gets
+//	the frame back without any disk I/O.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FRAMETABLE_H
+#define FRAMETABLE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "bitmap.h"
+
+class AddrSpace;
+class Lock;
+class Condition;
+class Thread;
+
+// Default sampling period for the reference bits, in ticks.
+const int WorkingSetSampleInterval = 1000;
+
+// Default working set window (tau), in ticks.  A page belongs to the
+// working set if it was referenced within the last tau ticks.
+const int WorkingSetWindow = 5000;
+
+// The pager starts cleaning when fewer than PagerLowWater frames are
+// free, and stops once PagerHighWater frames are free (or being
+// written back on their way to the free pool).
+const int PagerLowWater = 4;
+const int PagerHighWater = 16;
+
+// Scheduling priority of the pager thread: it has short bursts and
+// page faults wait on it, so run it ahead of user programs.
+const int PagerPriority = 149;
+
+// The following class defines one entry in the core map.
+
+class FrameEntry {
+  public:
+    AddrSpace *space;		// address space whose page is in this
+				// frame, NULL if none
+    int virtualPage;		// which page of "space" lives here
+    bool busy;			// TRUE while the frame is being filled
+				// or written back; never evict it then
+    bool free;			// TRUE if in the free pool; the page may
+				// still be reclaimed until reused
+    int sector;			// swap sector being written, while busy
+    bool pinned;		// part of a large page, never evicted
+};
+
+// The following class records the paging behaviour of one process.
+// It outlives the address space, so that processes which have already
+// exited still show up in the report printed when Nachos halts.
+
+class VMUsage {
+  public:
+    VMUsage(char *progName, int threadID);
+
+    AddrSpace *space;		// live address space, NULL once it exited
+    char *name;			// program name
+    int id;			// thread ID running the program
+    int resident;		// pages in memory (at exit, if exited)
+    int peakResident;		// largest resident set seen
+    int workingSet;		// working set size (at exit, if exited)
+    int faults;			// page faults taken
+    int ticks;			// user ticks executed
+
+    void Print();		// print one line of the halt report
+};
+
+// The following class defines the core map, together with the
+// replacement policy used to pick a victim frame.
+
+class FrameTable {
+  public:
+    FrameTable(int rssLimit, int wsWindow, bool useLargePages);
+				// Initialize the core map, with all
+				// frames free
+    ~FrameTable();
+
+    int Allocate(AddrSpace *space, int vpn);
+				// Find a frame for page "vpn" of "space",
+				// waiting for the pager if the pool is
+				// empty.  The frame is returned busy;
+				// -1 if memory and swap are full
+    int AllocateLarge(AddrSpace *space, int vpn);
+				// Find LargePagePages aligned free frames
+				// for the region at "vpn", pinned; -1 if
+				// there are none to spare
+    bool Reclaim(AddrSpace *space, int vpn, int frame);
+				// Take back "frame" from the free pool if
+				// it still holds page "vpn" of "space"
+    bool PagingOut(AddrSpace *space, int vpn, int frame);
+				// Is page "vpn" being written from "frame"?
+    void ReleaseSpace(AddrSpace *space);
+				// "space" is going away, free its frames
+    void WaitForPager();	// Wait until the pager frees some frames
+    void Unbusy(int frame) { frames[frame].busy = FALSE; }
+
+    int AllocSwap();		// Allocate a swap sector; -1 if the
+				// swap area is full
+    void FreeSwap(int sector);	// Free one
+
+    void SampleReferences();	// Harvest and clear the use bits of
+				// every resident page; called
+				// periodically from the timer
+
+    void Register(VMUsage *usage);
+				// Remember a process for the halt report
+    void Print();		// Print per-process paging statistics
+
+    int NumFree() { return freeFrames->NumInList(); }
+    int ResidentLimit() { return residentLimit; }
+    int Window() { return window; }
+    bool LargePages() { return largePages; }
+
+    void Pager();		// Body of the pager thread; never returns
+
+    Lock *vmLock;		// serializes page faults and evictions
+
+  private:
+    FrameEntry *frames;		// the core map, one entry per frame
+    List<int> *freeFrames;	// the pool of clean frames, oldest first
+    List<int> *dirtyFrames;	// victims waiting to be written back
+    Bitmap *swapMap;		// which swap sectors are in use
+    List<VMUsage *> *usages;	// every process that ever ran
+
+    Thread *pagerThread;	// started at the first page fault
+    Condition *pagerWake;	// the pool is low, wake up the pager
+    Condition *frameFreed;	// the pager put frames in the pool
+
+    int hand;			// clock hand for global replacement
+    int residentLimit;		// max resident pages per process
+    int window;			// working set window, in ticks
+    int nextSample;		// when to sample the use bits again
+    bool largePages;		// map big regions with large pages
+
+    bool CanPageOut(FrameEntry *entry);
+    				// Is there swap for the page in "entry"?
+    bool CanFreeFrame();	// Can the pager ever add to the pool?
+    int ChooseVictim(AddrSpace *space);
+    				// WSClock: pick a frame to evict,
+				// only among "space"'s frames if
+				// non-NULL
+    void PageOut(int frame);	// Unmap the page in "frame"; put the
+				// frame in the pool if clean, else
+				// queue it for the pager
+    void MakeFree(int frame);	// Put "frame" at the end of the pool
+};
+
+#endif // FRAMETABLE_H
@@ -14,6 +14,7 @@
 #include "kernel.h"
 #include "interrupt.h"
 #include "synchconsole.h"
+#include "textcache.h"
 
 int SysClose(int id)
 {
@@ -22,11 +23,21 @@ int SysClose(int id)
 
 int SysRead(char* buffer , int size , int id)
 {
+    if (id == SysConsoleInput) {		// for the shell
+        for (int i = 0; i < size; i++)
+            buffer[i] = kernel->synchConsoleIn->GetChar();
+        return size;
+    }
     return kernel->interrupt->Read(buffer, size, id);
 }
 
 int SysWrite(char* buffer , int size , int id)
 {
+    if (id == SysConsoleOutput) {
+        for (int i = 0; i < size; i++)
+            kernel->synchConsoleOut->PutChar(buffer[i]);
+        return size;
+    }
     return kernel->interrupt->Write(buffer, size, id);
 }
 
@@ -50,6 +61,43 @@ int SysAdd(int op1, int op2)
   return op1 + op2;
 }
 
+void SysSleep(int ticks)
+{
+  kernel->alarm->WaitUntil(ticks);
+}
+
+int SysExec(char *name)
+{
+  ExecImage *image;
+  char *copy;
+
+  // fail now if there is no such program; it stays cached for the child
+  image = kernel->textCache->Get(name);
+  if (image == NULL)
+    return -1;
+  kernel->textCache->Put(image);
+
+  copy = new char[strlen(name) + 1];	// names the thread from now on
+  strcpy(copy, name);
+  return kernel->Exec(copy, kernel->currentThread->getPriority());
+}
+
+int SysJoin(int id)
+{
+  return kernel->threadTable->Join(id);
+}
+
+void SysExit(int status)
+{
+  kernel->threadTable->Exit(kernel->currentThread, status);
+  kernel->currentThread->Finish();
+}
+
+int SysThreadFork(int func)
+{
+  return kernel->ThreadFork(func);
+}
+
 int SysCreate(char *filename)
 {
 	// return value
@@ -32,6 +32,7 @@
 #define SC_ExecV	13
 #define SC_ThreadExit   14
 #define SC_ThreadJoin   15
+#define SC_Sleep	16
 #define SC_Add		42
 #define SC_MSG		100
 
@@ -182,6 +183,11 @@ int ThreadJoin(ThreadId id);
  */
 void ThreadExit(int ExitCode);
 
+/* Put the current thread to sleep for at least "ticks" ticks of
+ * simulated time.
+ */
+void Sleep(int ticks);
+
 
 /* MP1 */
 void PrintInt(int number);
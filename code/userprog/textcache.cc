@@ -0,0 +1,157 @@
+// textcache.cc
+//	Routines to read executable files once, and share them.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "textcache.h"
+#include "main.h"
+#include "synch.h"
+
+//----------------------------------------------------------------------
+// ExecImage::ReadAt
+// 	Copy "numBytes" bytes, starting "position" bytes into the file,
+//	to "into".  As when reading the file itself, bytes past its end
+//	are not copied.
+//----------------------------------------------------------------------
+
+void
+ExecImage::ReadAt(char *into, int numBytes, int position)
+{
+    if (position < 0 || position >= length || numBytes <= 0)
+	return;
+    bcopy(contents + position, into, min(numBytes, length - position));
+}
+
+//----------------------------------------------------------------------
+// TextCache::TextCache
+// 	Initialize an empty cache.
+//
+//	"maxUnused" is how many images to keep once nobody uses them
+//----------------------------------------------------------------------
+
+TextCache::TextCache(int maxUnused)
+{
+    images = new List<ExecImage *>;
+    this->maxUnused = maxUnused;
+    lock = new Lock("text cache");
+    hits = misses = 0;
+}
+
+//----------------------------------------------------------------------
+// TextCache::~TextCache
+// 	De-allocate the cache, and every image in it.
+//----------------------------------------------------------------------
+
+TextCache::~TextCache()
+{
+    ExecImage *image;
+
+    while (!images->IsEmpty()) {
+	image = images->RemoveFront();
+	delete [] image->name;
+	delete [] image->contents;
+	delete image;
+    }
+    delete images;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// TextCache::Get
+// 	Return the image of the file "fileName", and count one more user
+//	of it.  If it is not in the cache yet, read the whole file in.
+//	Returns NULL if the file cannot be opened.
+//----------------------------------------------------------------------
+
+ExecImage *
+TextCache::Get(char *fileName)
+{
+    ListIterator<ExecImage *> iter(images);
+    ExecImage *image = NULL;
+    OpenFile *file;
+
+    lock->Acquire();
+    for (; !iter.IsDone(); iter.Next()) {
+	if (strcmp(iter.Item()->name, fileName) == 0) {
+	    image = iter.Item();
+	    break;
+	}
+    }
+    if (image != NULL) {
+	hits++;
+	images->Remove(image);		// move it to the front
+	DEBUG(dbgAddr, "Text cache hit on " << fileName << ", " << hits
+			<< " hits, " << misses << " misses");
+    } else {
+	file = kernel->fileSystem->Open(fileName);
+	if (file == NULL) {
+	    lock->Release();
+	    return NULL;
+	}
+	misses++;
+	image = new ExecImage;
+	image->name = new char[strlen(fileName) + 1];
+	strcpy(image->name, fileName);
+	image->length = file->Length();
+	image->contents = new char[max(image->length, 1)];
+	image->length = file->ReadAt(image->contents, image->length, 0);
+	image->refs = 0;
+	delete file;
+	DEBUG(dbgAddr, "Text cache read " << image->length << " bytes of "
+			<< fileName);
+    }
+    images->Prepend(image);
+    image->refs++;
+    lock->Release();
+    return image;
+}
+
+//----------------------------------------------------------------------
+// TextCache::Put
+// 	One user less for "image".  If that was the last one, it stays
+//	cached for a while, until it is among the least recently used.
+//----------------------------------------------------------------------
+
+void
+TextCache::Put(ExecImage *image)
+{
+    lock->Acquire();
+    ASSERT(image->refs > 0);
+    image->refs--;
+    if (image->refs == 0)
+	Trim();
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// TextCache::Trim
+// 	Throw out images nobody uses, least recently used first, until
+//	no more than maxUnused of them are left.
+//
+//	Called with the lock held.
+//----------------------------------------------------------------------
+
+void
+TextCache::Trim()
+{
+    ListIterator<ExecImage *> iter(images);
+    List<ExecImage *> doomed;
+    ExecImage *image;
+    int kept = 0;
+
+    for (; !iter.IsDone(); iter.Next()) {	// most recently used first
+	if (iter.Item()->refs == 0 && kept++ >= maxUnused)
+	    doomed.Append(iter.Item());
+    }
+    while (!doomed.IsEmpty()) {
+	image = doomed.RemoveFront();
+	images->Remove(image);
+	DEBUG(dbgAddr, "Text cache drops " << image->name);
+	delete [] image->name;
+	delete [] image->contents;
+	delete image;
+    }
+}
@@ -0,0 +1,70 @@
+// textcache.h
+//	Data structures to share executable files between the programs
+//	running them.
+//
+//	The first time a program is started, its whole NOFF file is
+//	read into kernel memory; every address space running the same
+//	file then pages its code and data in from that one copy instead
+//	of opening and reading the file again.  An image stays cached
+//	while some address space uses it, and the last few images
+//	nobody uses are kept as well, so that a program that is started
+//	over and over (by a shell, say) is read from disk only once.
+//
+//	Only the file contents are shared; every address space still
+//	gets page frames of its own.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include "copyright.h"
+#include "list.h"
+
+class Lock;
+
+// Default number of unused images to keep.
+const int TextCacheSize = 4;
+
+// The following class defines one executable file, read into memory.
+
+class ExecImage {
+  public:
+    char *name;			// file it was read from
+    char *contents;		// the whole file
+    int length;			// its length, in bytes
+    int refs;			// address spaces using it
+
+    void ReadAt(char *into, int numBytes, int position);
+				// Like OpenFile::ReadAt; what lies past
+				// the end of the file is left alone
+};
+
+// The following class defines the cache of images.
+
+class TextCache {
+  public:
+    TextCache(int maxUnused);	// Keep at most "maxUnused" images that
+				// nobody uses
+    ~TextCache();
+
+    ExecImage *Get(char *fileName);
+				// The image of "fileName", read in if it
+				// is not cached; NULL if there is no such
+				// file.  Must be given back with Put
+    void Put(ExecImage *image);	// Done with "image"
+
+  private:
+    List<ExecImage *> *images;	// every cached image, most recently
+				// used first
+    int maxUnused;
+    Lock *lock;			// reading a file may block
+    int hits, misses;
+
+    void Trim();		// Throw out the least recently used
+				// images nobody uses, down to maxUnused
+};
+
+#endif // TEXTCACHE_H